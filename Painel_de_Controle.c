@@ -2,11 +2,28 @@
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
 #include "lib/ssd1306.h"
+#include "lib/telas.h"
 #include "lib/buzzer.h"
+#include "lib/led.h"
+#include "lib/eventos.h"
+#include "lib/ocupacao.h"
+#include "lib/zonas.h"
+#include "lib/rastro.h"
+#include "lib/saidas.h"
+#include "lib/latencia.h"
+#include "lib/persistencia.h"
+#include "lib/telemetria.h"
+#include "lib/energia.h"
+#include "lib/supervisor.h"
+#if PAINEL_BOTOES_PIO
+#include "lib/botoes.h"
+#endif
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"
+#include "queue.h"
+#include "timers.h"
 #include <stdio.h>
+#include <string.h>
 
 #define BOTAO_A 5           // pino do botão A
 #define BOTAO_B 6           // pino do botão B
@@ -15,293 +32,893 @@
 #define LED_PIN_RED 13      // vermelho
 #define BUZZER_PIN 21       // pino do buzzer
 #define JOYSTICK_BTN_PIN 22 // pino do botão do joystick
+#ifndef LED_BRILHO
+#define LED_BRILHO 255      // brilho do LED RGB no modo PWM (0-255)
+#endif
+
+// Núcleos de cada grupo de tarefas (usados apenas no modo SMP)
+#define NUCLEO_LOGICA (1 << 0) // entrada e contagem
+#define NUCLEO_IO (1 << 1)     // display, LED e buzzer
+
+#define DEBOUNCE_MS 50             // janela de debounce de cada botão
+#ifndef DEBOUNCE_PIO_US
+#define DEBOUNCE_PIO_US 5000      // tempo em 0 para a PIO aceitar um pressionamento
+#endif
+#define DISPLAY_HOLD_MS 1000      // tempo de exibição das telas de evento
+#define DISPLAY_MIN_PERIOD_MS 50  // intervalo mínimo entre quadros enviados
+#define CONSOLE_PERIODO_MS 20     // envio da telemetria e leitura de comandos
+#define CONSOLE_OCIOSO_MS 250     // o mesmo com o display desligado (modo economia)
+#define PERDAS_PERIODO_MS 1000    // contadores de descarte (só quando mudam)
+#define RASTRO_SILENCIO_US 2000000 // sem dados por este tempo encerra a reprodução
+#define SAIDAS_REENVIO_MS 10      // nova tentativa com uma atualização retida (fila cheia)
+
+// Supervisor: prazo de cada etapa por evento, período de verificação e
+// tempo sem alimentar o watchdog até o reset (0 desliga o watchdog)
+#define PRAZO_ENTRADA_MS 50   // ISR -> tarefa de eventos
+#define PRAZO_LOGICA_MS 50    // lote aplicado e publicado
+#define PRAZO_DISPLAY_MS 500  // estado de tela -> quadro no display
+#define SUPERVISOR_PERIODO_MS 100
+#ifndef WATCHDOG_MS
+#define WATCHDOG_MS 2000
+#endif
+
+// Modo economia: tempo sem eventos até reduzir o contraste e até desligar o painel
+#ifndef DISPLAY_ESMAECER_MS
+#define DISPLAY_ESMAECER_MS 30000
+#endif
+#ifndef DISPLAY_DESLIGAR_MS
+#define DISPLAY_DESLIGAR_MS 120000
+#endif
+#define CONTRASTE_PLENO 0xFF
+#define CONTRASTE_ESMAECIDO 0x10
+
+// Pilha de cada tarefa (palavras); ajuste pelo mínimo livre medido (comando 't')
+#define PILHA_EVENTOS (configMINIMAL_STACK_SIZE + 128)
+#define PILHA_SAIDAS (configMINIMAL_STACK_SIZE + 128)
+#define PILHA_DISPLAY (configMINIMAL_STACK_SIZE + 128)
+#define PILHA_COMANDOS (configMINIMAL_STACK_SIZE + 128)
+#define PILHA_PERSISTENCIA (configMINIMAL_STACK_SIZE + 128)
+#define PILHA_SUPERVISOR (configMINIMAL_STACK_SIZE + 64)
+#define TAREFAS_MAX 6
+
+// Estado de debounce de cada botão e o evento que ele gera
+typedef struct
+{
+    uint pino;
+    evento_tipo_t tipo;
+    uint8_t porta;
+    uint32_t ultimo_us; // instante da última borda aceita
+} botao_t;
+
+static botao_t botoes[] = {
+    {BOTAO_A, EVENTO_ENTRADA, PORTA_PRINCIPAL, 0},
+    {BOTAO_B, EVENTO_SAIDA, PORTA_PRINCIPAL, 0},
+    {JOYSTICK_BTN_PIN, EVENTO_RESET, 0, 0},
+};
+
+eventos_fila_t filaEventos;      // eventos dos botões (produzidos na ISR)
+TaskHandle_t xTaskEventos;       // tarefa que consome filaEventos
+saidas_fila_t filaSaidas;        // atualizações da lógica para a tarefa de saídas
+TaskHandle_t xTaskSaidas;        // tarefa que consome filaSaidas
+TaskHandle_t xTaskPersistencia;  // tarefa que grava o log de eventos na flash
+tel_canal_t telEventos;          // telemetria da tarefa de eventos
+tel_canal_t telDisplay;          // telemetria da tarefa do display
+QueueHandle_t xTelaQueue;        // estado de tela mais recente para o renderizador
+TimerHandle_t xTimerEspera;      // retorna à tela de espera após DISPLAY_HOLD_MS
+
+// Reprodução de rastros pelo console (comandos r e R)
+volatile bool rastro_ativo;                       // botões ignorados durante a reprodução
+uint16_t usuarios_publicados[OCUPACAO_MAX_ZONAS]; // contagem após o último lote
+volatile uint32_t eventos_consumidos;             // eventos retirados da fila e já aplicados
+
+ssd1306_t ssd;                 // variavel do display
+TaskHandle_t xDisplayWaiter;   // tarefa aguardando o fim do envio assíncrono
+volatile bool display_sem_dma; // aviso para o console: display no envio bloqueante
+
+// Chamado pela IRQ da DMA ao terminar o envio do quadro
+void display_dma_done(void *ctx)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    if (xDisplayWaiter != NULL)
+        vTaskNotifyGiveFromISR(xDisplayWaiter, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+// Melodias do buzzer (tocadas pelo sequenciador, sem bloquear as tarefas)
+static const buzzer_nota_t melodia_lotado[] = {{3000, 150}};
+static const buzzer_nota_t melodia_reset[] = {{2000, 120}, {0, 100}, {2500, 120}};
+
+// Mensagem enviada ao renderizador: qual tela mostrar e a contagem atual da zona
+typedef struct
+{
+    tela_t tela;
+    uint8_t zona;
+    uint16_t usuarios;
+} estado_tela_t;
+
+// Publica o novo estado da tela. A fila tem uma posição e é sobrescrita,
+// então um acúmulo de eventos se reduz ao estado mais recente.
+void mostrar_tela(tela_t tela, uint8_t zona, uint16_t usuarios)
+{
+    estado_tela_t estado = {tela, zona, usuarios};
+    xQueueOverwrite(xTelaQueue, &estado);
+}
+
+// Expiração do tempo de exibição: volta para a tela de espera
+void vTimerEspera(TimerHandle_t xTimer)
+{
+    estado_tela_t estado = {TELA_ESPERA, 0, 0};
+    // Não sobrescreve: se já há um evento pendente ele tem prioridade
+    xQueueSend(xTelaQueue, &estado, 0);
+}
+
+// Desenha o estado no back buffer do display
+void desenhar_tela(const estado_tela_t *estado)
+{
+    // Telas pré-renderizadas (lib/telas.cpp): uma cópia por coluna e os algarismos da contagem
+    telas_desenhar(&ssd, estado->tela, zonas[estado->zona].nome, estado->usuarios);
+}
+
+// Registra a latência da etapa para cada tipo de evento presente na máscara
+static void registrar_latencias(uint8_t tipos, const uint32_t origem_us[EVENTO_TIPOS], latencia_etapa_t etapa)
+{
+    uint32_t agora = time_us_32();
+    for (uint8_t t = 0; t < EVENTO_TIPOS; ++t)
+        if (tipos & (1u << t))
+            latencia_registrar(t, etapa, agora - origem_us[t]);
+}
+
+// Quadro entregue ao barramento e ainda não concluído: a tela e os eventos
+// que ela representa, para a latência ISR -> tela e a telemetria
+static struct
+{
+    bool pendente;
+    bool enviado; // false quando era igual ao quadro da frente
+    tela_t tela;
+    uint8_t tipos;
+    uint32_t origem_us[EVENTO_TIPOS];
+} quadro_envio;
+
+// Timeouts do barramento já tratados por display_recuperar
+static uint32_t timeouts_vistos;
+
+// Libera o barramento e refaz initDisplay, que reenvia o back buffer inteiro
+// (ssd1306_recover). A configuração deixa o painel ligado e no contraste
+// pleno; o nível de economia é reaplicado pela tarefa em seguida.
+static void display_recuperar(void)
+{
+    ssd1306_recover(&ssd);
+    timeouts_vistos = ssd.timeouts; // inclusive os da própria recuperação
+    energia_display(ENERGIA_PLENO);
+}
+
+// Espera o fim do quadro em envio liberando a CPU e registra a latência e
+// a telemetria dele. Usada apenas pela tarefa do display.
+static void display_aguardar(void)
+{
+    if (ssd.dma_busy)
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+    // DMA parada ou transação expirada: o barramento travou
+    if (ssd.dma_busy || ssd.timeouts != timeouts_vistos)
+        display_recuperar();
 
-// semáforos utilizados
-SemaphoreHandle_t xContadorSemA; // controla as solicitações de entrada
-SemaphoreHandle_t xContadorSemB; // controla as solicitações de saída
-SemaphoreHandle_t xDisplayMutex; // controla as solicitaçõe de reset
-SemaphoreHandle_t xResetSem;     // controla as solicitações de acesso ao display
+    // Quadro concluído: fim da etapa do supervisor aberta para ele
+    sup_fim(SUP_DISPLAY);
 
-ssd1306_t ssd;                // variavel do display
-uint16_t usuariosNoLocal = 0; // armazena a quantidade de usuários no local
-uint32_t last_time;           // armazena o tempo do último clique nos botões
-uint8_t MAX = 8;              // número máixmo de pessoas no espaço
+    if (!quadro_envio.pendente)
+        return;
+    quadro_envio.pendente = false;
+    registrar_latencias(quadro_envio.tipos, quadro_envio.origem_us, LAT_TELA);
 
-// Função responsável por resetar o sistema
-void vTaskReset(void *params)
+    tel_quadro_t quadro = {time_us_32(), quadro_envio.enviado ? ssd.last_xfer_us : 0, ssd.bytes_saved,
+                           ssd.frames_skipped, quadro_envio.tela};
+    tel_enviar(&telDisplay, TEL_QUADRO, &quadro, sizeof(quadro));
+}
+
+// Troca os buffers: o quadro desenhado segue para o display em segundo plano
+// e o back buffer fica livre para a próxima tela. A etapa do supervisor vai
+// de recebido_us (estado recebido) até o fim do envio deste quadro.
+static void display_trocar(tela_t tela, uint8_t tipos, const uint32_t origem_us[EVENTO_TIPOS], uint32_t recebido_us)
+{
+    display_aguardar();
+    ulTaskNotifyTake(pdTRUE, 0); // aviso de fim de um quadro já concluído
+
+    uint32_t iguais = ssd.frames_skipped;
+    quadro_envio.tela = tela;
+    quadro_envio.tipos = tipos;
+    memcpy(quadro_envio.origem_us, origem_us, sizeof(quadro_envio.origem_us));
+    quadro_envio.pendente = true;
+    ssd1306_swap(&ssd);
+    quadro_envio.enviado = ssd.frames_skipped == iguais;
+    sup_inicio(SUP_DISPLAY, recebido_us);
+}
+
+// Aplica o estado de energia ao painel. Ao religar, o quadro já enviado
+// para a RAM do display aparece direto, sem um quadro antigo no meio.
+static void display_energia(energia_display_t nivel)
+{
+    energia_display_t atual = energia_display_nivel();
+    if (nivel == atual)
+        return;
+
+    // Os comandos esperam o barramento: aguarda o quadro em envio sem ocupar a CPU
+    display_aguardar();
+    if (nivel == ENERGIA_DESLIGADO)
+    {
+        ssd1306_power(&ssd, false);
+    }
+    else
+    {
+        ssd1306_contrast(&ssd, nivel == ENERGIA_PLENO ? CONTRASTE_PLENO : CONTRASTE_ESMAECIDO);
+        if (atual == ENERGIA_DESLIGADO)
+            ssd1306_power(&ssd, true);
+    }
+    energia_display(nivel);
+}
+
+// Estado de energia para o tempo sem eventos e quanto falta para o próximo
+static energia_display_t display_nivel_ocioso(TickType_t parado, TickType_t *espera)
+{
+    if (!PAINEL_ECONOMIA)
+    {
+        *espera = portMAX_DELAY;
+        return ENERGIA_PLENO;
+    }
+    if (parado < pdMS_TO_TICKS(DISPLAY_ESMAECER_MS))
+    {
+        *espera = pdMS_TO_TICKS(DISPLAY_ESMAECER_MS) - parado;
+        return ENERGIA_PLENO;
+    }
+    if (parado < pdMS_TO_TICKS(DISPLAY_DESLIGAR_MS))
+    {
+        *espera = pdMS_TO_TICKS(DISPLAY_DESLIGAR_MS) - parado;
+        return ENERGIA_ESMAECIDO;
+    }
+    *espera = portMAX_DELAY;
+    return ENERGIA_DESLIGADO;
+}
+
+// Única tarefa que acessa o display: recebe estados de tela e os desenha,
+// limitando a taxa de atualização a DISPLAY_MIN_PERIOD_MS. No modo economia
+// também esmaece e desliga o painel após um tempo sem eventos.
+void vTaskDisplay(void *params)
 {
-    char buffer[32]; // Buffer para armazenar texto que será exibido no display
+    estado_tela_t estado = {TELA_ESPERA, 0, 0};
+    TickType_t ultimo_envio = xTaskGetTickCount() - pdMS_TO_TICKS(DISPLAY_MIN_PERIOD_MS);
+    TickType_t ultimo_evento = 0;
+    TickType_t ultima_atividade = xTaskGetTickCount();
+    uint32_t origem_us[EVENTO_TIPOS] = {0};
+
+    // O display é iniciado pela própria tarefa para que a IRQ da DMA
+    // fique no mesmo núcleo que ela
+    initDisplay(&ssd);
+
+    // Envio assíncrono por DMA (sem canal livre, continua no modo bloqueante)
+    xDisplayWaiter = xTaskGetCurrentTaskHandle();
+    // O aviso sai pelo console, o único que escreve na USB após o boot
+    if (!ssd1306_dma_init(&ssd, display_dma_done, NULL))
+        display_sem_dma = true;
+
+    // Mostra mensagem de "aguardando evento" no display
+    desenhar_tela(&estado);
+    display_trocar(estado.tela, 0, origem_us, time_us_32());
 
     while (true)
     {
-        // Espera até o semáforo de reset ser liberado
-        if (xSemaphoreTake(xResetSem, portMAX_DELAY) == pdTRUE)
+        // Prazo perdido sem timeout visto aqui (ex.: preso esperando o barramento)
+        if (sup_pedido(SUP_DISPLAY))
+            display_recuperar();
+
+        // Nada novo para desenhar: conclui o quadro em envio antes de bloquear
+        if (uxQueueMessagesWaiting(xTelaQueue) == 0)
+            display_aguardar();
+
+        // Sem eventos até a próxima etapa de economia: muda o brilho e volta a esperar
+        TickType_t espera;
+        display_energia(display_nivel_ocioso(xTaskGetTickCount() - ultima_atividade, &espera));
+        if (xQueueReceive(xTelaQueue, &estado, espera) != pdTRUE)
+            continue;
+        uint32_t recebido_us = time_us_32();
+        sup_inicio(SUP_DISPLAY, recebido_us);
+
+        // Respeita o intervalo mínimo entre quadros e pega o estado mais recente
+        TickType_t decorrido = xTaskGetTickCount() - ultimo_envio;
+        if (decorrido < pdMS_TO_TICKS(DISPLAY_MIN_PERIOD_MS))
+        {
+            vTaskDelay(pdMS_TO_TICKS(DISPLAY_MIN_PERIOD_MS) - decorrido);
+            xQueueReceive(xTelaQueue, &estado, 0);
+        }
+
+        // Tela de espera atrasada (o timer expirou junto com um novo evento)
+        if (estado.tela == TELA_ESPERA && ultimo_evento != 0 &&
+            xTaskGetTickCount() - ultimo_evento < pdMS_TO_TICKS(DISPLAY_HOLD_MS))
+            continue;
+
+        // Eventos representados por esta tela (o mais antigo de cada tipo)
+        uint8_t tipos = 0;
+        if (estado.tela != TELA_ESPERA)
+            tipos = latencia_coletar(origem_us);
+        registrar_latencias(tipos, origem_us, LAT_DISPLAY);
+
+        // O desenho no back buffer pode coincidir com o envio do quadro anterior.
+        // Um evento desenha a sua tela e religa o painel: o primeiro toque
+        // é contado e mostrado, não apenas acorda o display
+        desenhar_tela(&estado);
+        display_trocar(estado.tela, tipos, origem_us, recebido_us);
+        if (estado.tela != TELA_ESPERA)
+        {
+            display_energia(ENERGIA_PLENO);
+            ultima_atividade = xTaskGetTickCount();
+        }
+        ultimo_envio = xTaskGetTickCount();
+
+        // Telas de evento ficam visíveis por DISPLAY_HOLD_MS antes da tela de espera
+        if (estado.tela != TELA_ESPERA)
         {
-            // Reseta a contagem de usuários presentes
-            usuariosNoLocal = 0;
-
-            // Desliga todos os LEDs
-            gpio_put(LED_PIN_GREEN, false);
-            gpio_put(LED_PIN_BLUE, false);
-            gpio_put(LED_PIN_RED, false);
-
-            // Liga o LED azul indicando que não há usuários no local
-            gpio_put(LED_PIN_BLUE, true);
-
-            // Emite dois beeps com o buzzer para indicar o reset
-            buzzer_play(BUZZER_PIN, 2000, 120); 
-            vTaskDelay(pdMS_TO_TICKS(100));     
-            buzzer_play(BUZZER_PIN, 2500, 120);
-
-            // Tenta obter o mutex para acessar o display com segurança
-            if (xSemaphoreTake(xDisplayMutex, portMAX_DELAY) == pdTRUE)
-            {
-                // Limpa o display e exibe mensagem de reset
-                ssd1306_fill(&ssd, 0);
-                sprintf(buffer, "Usuarios: %d", usuariosNoLocal);
-                ssd1306_draw_string(&ssd, "Reset ", 5, 10);
-                ssd1306_draw_string(&ssd, "Detectado!", 5, 19);
-                ssd1306_draw_string(&ssd, buffer, 5, 44);
-                ssd1306_send_data(&ssd);
-
-                // Mensagem de debug
-                printf("Tarefa 3 ativa\n");
-
-                vTaskDelay(1000 / portTICK_PERIOD_MS);
-
-                // Exibe mensagem de tela de espera no display
-                ssd1306_fill(&ssd, 0);
-                ssd1306_draw_string(&ssd, "Aguardando ", 5, 25);
-                ssd1306_draw_string(&ssd, "  evento...", 5, 34);
-                ssd1306_send_data(&ssd);
-
-                // Libera o mutex do display
-                xSemaphoreGive(xDisplayMutex);
-            }
+            ultimo_evento = ultimo_envio;
+            xTimerReset(xTimerEspera, 0);
         }
     }
 }
 
-// Função responsável por lidar com a entrada de usuários no local
-void vTaskEntrada(void *params)
+// Tela exibida para o resultado do último evento de um lote
+static const tela_t tela_resultado[] = {
+    [OCUPACAO_RES_ENTRADA] = TELA_ENTRADA,
+    [OCUPACAO_RES_SAIDA] = TELA_SAIDA,
+    [OCUPACAO_RES_LOTADO] = TELA_LOTADO,
+    [OCUPACAO_RES_VAZIO] = TELA_VAZIO,
+    [OCUPACAO_RES_RESET] = TELA_RESET,
+};
+
+// Estado do LED para cada nível de ocupação. No modo GPIO o amarelo é verde +
+// vermelho e a cor fica fixa; com PWM as cores são misturadas e o lotado pulsa.
+static const led_estado_t estados_led[] = {
+    [OCUPACAO_VAZIO] = {{0, 0, 255}, LED_FIXO, 0},         // azul
+    [OCUPACAO_LIVRE] = {{0, 255, 0}, LED_FIXO, 0},         // verde
+    [OCUPACAO_QUASE_CHEIO] = {{255, 160, 0}, LED_FIXO, 0}, // amarelo: uma vaga
+    [OCUPACAO_LOTADO] = {{255, 0, 0}, LED_RESPIRAR, 1500}, // vermelho
+};
+
+// Atualiza o LED RGB para o nível de ocupação da zona do último evento
+void atualizar_led(ocupacao_nivel_t nivel)
+{
+    led_aplicar(&estados_led[nivel]);
+}
+
+// Aplica a atualização consolidada: LED, buzzer e display uma única vez
+void aplicar_saida(const ocupacao_saida_t *saida)
+{
+    atualizar_led(saida->nivel);
+
+    // Contagem restaurada da flash no boot: só o LED
+    if (saida->eventos == 0)
+        return;
+
+    // Dois beeps para o reset; o alarme de lotação tem prioridade e o interrompe
+    if (saida->reset)
+        buzzer_seq_play(melodia_reset, count_of(melodia_reset), BUZZER_PRIO_AVISO);
+    if (saida->alarme_lotado)
+        buzzer_seq_play(melodia_lotado, count_of(melodia_lotado), BUZZER_PRIO_ALARME);
+
+    mostrar_tela(tela_resultado[saida->ultimo], saida->zona, saida->usuarios);
+}
+
+// Única dona da contagem: esvazia a fila de eventos dos botões em lotes,
+// aplica cada lote em ordem cronológica e publica uma atualização por lote
+void vTaskEventos(void *params)
 {
-    char buffer[32];
+    static evento_t lote[EVENTOS_CAPACIDADE];
+    ocupacao_t ocupacao;
+    ocupacao_saida_t saida = {0};
+    saidas_retida_t retida = {0};
+
+    if (!ocupacao_init(&ocupacao, zonas, count_of(zonas), portas, count_of(portas)))
+        panic("Configuracao de zonas/portas invalida");
+
+    // Retoma a contagem salva na flash antes do primeiro evento. Após um reset
+    // do watchdog a cópia nos registradores dele é mais recente que a flash.
+    bool restaurado = persist_recuperar(&ocupacao);
+    if (sup_restaurar(ocupacao.usuarios, ocupacao.n_zonas))
+    {
+        persist_retomar(&ocupacao);
+        restaurado = true;
+    }
+    if (restaurado)
+    {
+        // Sem reset nem alarme: zerados na declaração, para não se somarem ao
+        // primeiro lote se os dois forem juntados na fila de saídas
+        saida.zona = 0;
+        saida.usuarios = ocupacao.usuarios[0];
+        saida.nivel = ocupacao_nivel(&ocupacao, 0);
+        saida.eventos = 0;
+        saidas_publicar(&filaSaidas, &retida, &saida);
+        xTaskNotifyGive(xTaskSaidas);
+        memcpy(usuarios_publicados, ocupacao.usuarios, sizeof(usuarios_publicados));
+
+        tel_restaurado_t tel = {time_us_32(), saida.usuarios, saida.zona};
+        tel_enviar(&telEventos, TEL_RESTAURADO, &tel, sizeof(tel));
+    }
 
     while (true)
     {
-        // Espera pelo semáforo de entrada
-        if (xSemaphoreTake(xContadorSemA, portMAX_DELAY) == pdTRUE)
+        sup_fim(SUP_LOGICA);
+
+        // Aguarda a ISR sinalizar novos eventos. Os avisos acumulados valem por
+        // um, então o que passou de um lote é consumido sem esperar o próximo.
+        // Com uma atualização retida a espera é limitada para tentar de novo.
+        if (eventos_pendentes(&filaEventos) == 0)
+            ulTaskNotifyTake(pdTRUE, retida.pendente ? pdMS_TO_TICKS(SAIDAS_REENVIO_MS) : portMAX_DELAY);
+        if (saidas_publicar(&filaSaidas, &retida, NULL))
+            xTaskNotifyGive(xTaskSaidas);
+
+        uint8_t n = 0;
+        while (n < EVENTOS_CAPACIDADE && eventos_pop(&filaEventos, &lote[n]))
+            n++;
+        if (n == 0)
+            continue;
+        sup_inicio(SUP_LOGICA, time_us_32());
+
+        // Latência ISR -> tarefa; os eventos passam a aguardar a tela
+        uint32_t agora = time_us_32();
+        for (uint8_t i = 0; i < n; ++i)
         {
-            // Desliga todos os LEDs inicialmente
-            gpio_put(LED_PIN_GREEN, false);
-            gpio_put(LED_PIN_BLUE, false);
-            gpio_put(LED_PIN_RED, false);
-
-            // Se ainda há vagas no local
-            if (usuariosNoLocal < MAX)
-            {
-                usuariosNoLocal++; // Incrementa o número de usuários presentes
-
-                if (usuariosNoLocal < MAX - 1)
-                {
-                    // Situação normal: ainda há várias vagas - LED verde
-                    gpio_put(LED_PIN_GREEN, true);
-                }
-                else if (usuariosNoLocal == MAX - 1)
-                {
-                    // Apenas uma vaga restante - LED amarelo (verde + vermelho)
-                    gpio_put(LED_PIN_GREEN, true);
-                    gpio_put(LED_PIN_RED, true);
-                }
-                else if (usuariosNoLocal == MAX)
-                {
-                    // Capacidade máxima atingida - LED vermelho + buzzer
-                    gpio_put(LED_PIN_RED, true);
-                    buzzer_play(BUZZER_PIN, 3000, 150);
-                }
-
-                // Tenta acessar o display
-                if (xSemaphoreTake(xDisplayMutex, portMAX_DELAY) == pdTRUE)
-                {
-                    // Atualiza o display com a mensagem de entrada detectada
-                    ssd1306_fill(&ssd, 0); 
-                    sprintf(buffer, "Usuarios: %d", usuariosNoLocal);
-                    ssd1306_draw_string(&ssd, "Entrada ", 5, 10);
-                    ssd1306_draw_string(&ssd, "Detectada!", 5, 19);
-                    ssd1306_draw_string(&ssd, buffer, 5, 44);
-                    ssd1306_send_data(&ssd);
-                    printf("Tarefa 1 ativa\n");
-
-                    vTaskDelay(1000 / portTICK_PERIOD_MS);
-
-                    // Retorna para a tela padrão de espera
-                    ssd1306_fill(&ssd, 0);
-                    ssd1306_draw_string(&ssd, "Aguardando ", 5, 25);
-                    ssd1306_draw_string(&ssd, "  evento...", 5, 34);
-                    ssd1306_send_data(&ssd);
-
-                    // Libera o acesso ao display
-                    xSemaphoreGive(xDisplayMutex);
-                }
-            }
-            else // Caso o local já esteja cheio
-            {
-                // Capacidade máxima - LED vermelho + buzzer
-                gpio_put(LED_PIN_RED, true);
-                buzzer_play(BUZZER_PIN, 3000, 150);
-
-                if (xSemaphoreTake(xDisplayMutex, portMAX_DELAY) == pdTRUE)
-                {
-                    ssd1306_fill(&ssd, 0);
-                    sprintf(buffer, "Usuarios: %d", usuariosNoLocal);
-                    ssd1306_draw_string(&ssd, "Espaco ", 5, 10);
-                    ssd1306_draw_string(&ssd, "Lotado!", 5, 19);
-                    ssd1306_draw_string(&ssd, buffer, 5, 44);
-                    ssd1306_send_data(&ssd);
-                    printf("Tarefa 1 ativa\n");
-
-                    // Tempo de exibição
-                    vTaskDelay(1000 / portTICK_PERIOD_MS);
-
-                    // Tela de espera padrão
-                    ssd1306_fill(&ssd, 0);
-                    ssd1306_draw_string(&ssd, "Aguardando ", 5, 25);
-                    ssd1306_draw_string(&ssd, "  evento...", 5, 34);
-                    ssd1306_send_data(&ssd);
-
-                    xSemaphoreGive(xDisplayMutex);
-                }
-            }
+            tel_evento_t tel = {lote[i].timestamp_us, agora - lote[i].timestamp_us, lote[i].tipo, lote[i].porta};
+            latencia_registrar(lote[i].tipo, LAT_FILA, tel.latencia_us);
+            latencia_pendente(lote[i].tipo, lote[i].timestamp_us);
+            tel_enviar(&telEventos, TEL_EVENTO, &tel, sizeof(tel));
         }
+
+        uint8_t aplicados = ocupacao_processar(&ocupacao, lote, n, &saida);
+        sup_salvar(ocupacao.usuarios, ocupacao.n_zonas);
+        memcpy(usuarios_publicados, ocupacao.usuarios, sizeof(usuarios_publicados));
+        __dmb(); // a contagem fica visível antes do total consumido
+        eventos_consumidos += n;
+        if (aplicados == 0)
+            continue;
+
+        tel_lote_t tel = {time_us_32(), saida.usuarios, saida.zona, saida.ultimo, saida.eventos,
+                          (saida.alarme_lotado ? TEL_LOTE_LOTADO : 0) | (saida.reset ? TEL_LOTE_RESET : 0)};
+        tel_enviar(&telEventos, TEL_LOTE, &tel, sizeof(tel));
+
+        // Entrega a atualização para a tarefa de saídas e o lote para o log na flash
+        if (saidas_publicar(&filaSaidas, &retida, &saida))
+            xTaskNotifyGive(xTaskSaidas);
+        persist_anotar(lote, n);
+        xTaskNotifyGive(xTaskPersistencia);
     }
 }
 
-// Função responsável por tratar a saída de usuários do local
-void vTaskSaida(void *params)
+// Tarefa de saídas: LED, buzzer e estado do display. Junta as atualizações
+// pendentes em uma só, mantendo a contagem mais recente e os avisos sonoros de todas.
+void vTaskSaidas(void *params)
 {
-    char buffer[32];
+    ocupacao_saida_t saida, proxima;
+
+    // O alarme do sequenciador é criado neste núcleo
+    buzzer_seq_init(BUZZER_PIN);
 
     while (true)
     {
-        // Aguarda o semáforo de saída
-        if (xSemaphoreTake(xContadorSemB, portMAX_DELAY) == pdTRUE)
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (!saidas_pop(&filaSaidas, &saida))
+            continue;
+        while (saidas_pop(&filaSaidas, &proxima))
         {
-            // Desliga todos os LEDs
-            gpio_put(LED_PIN_GREEN, false);
-            gpio_put(LED_PIN_BLUE, false);
-            gpio_put(LED_PIN_RED, false);
-
-            if (usuariosNoLocal > 0)
-            {
-                usuariosNoLocal--; // Decrementa o número de usuários no local
-
-                if (usuariosNoLocal == 0)
-                {
-                    // Nenhum usuário - LED azul
-                    gpio_put(LED_PIN_BLUE, true);
-                }
-                else if (usuariosNoLocal < MAX - 1)
-                {
-                    // Ainda há várias vagas - LED verde
-                    gpio_put(LED_PIN_GREEN, true);
-                }
-                else if (usuariosNoLocal == MAX - 1)
-                {
-                    // Apenas 1 vaga disponível - LED amarelo (verde + vermelho)
-                    gpio_put(LED_PIN_GREEN, true);
-                    gpio_put(LED_PIN_RED, true);
-                }
-
-                // Atualiza o display com a saída detectada
-                if (xSemaphoreTake(xDisplayMutex, portMAX_DELAY) == pdTRUE)
-                {
-                    ssd1306_fill(&ssd, 0);
-                    sprintf(buffer, "Usuarios: %d", usuariosNoLocal);
-                    ssd1306_draw_string(&ssd, "Saida ", 5, 10);
-                    ssd1306_draw_string(&ssd, "Detectada!", 5, 19);
-                    ssd1306_draw_string(&ssd, buffer, 5, 44);
-                    ssd1306_send_data(&ssd);
-                    printf("Tarefa 2 ativa\n");
-
-                    // Tempo de exibição da mensagem
-                    vTaskDelay(1000 / portTICK_PERIOD_MS);
-
-                    // Tela de espera padrão
-                    ssd1306_fill(&ssd, 0);
-                    ssd1306_draw_string(&ssd, "Aguardando ", 5, 25);
-                    ssd1306_draw_string(&ssd, "  evento...", 5, 34);
-                    ssd1306_send_data(&ssd);
-
-                    // Libera o mutex do display
-                    xSemaphoreGive(xDisplayMutex);
-                }
-            }
-            else
-            {
-                // Se não há usuários no local, mostra que o espaço está vazio
-                gpio_put(LED_PIN_BLUE, true); // LED azul
-
-                if (xSemaphoreTake(xDisplayMutex, portMAX_DELAY) == pdTRUE)
-                {
-                    ssd1306_fill(&ssd, 0);
-                    sprintf(buffer, "Usuarios: %d", usuariosNoLocal);
-                    ssd1306_draw_string(&ssd, "Espaco ", 5, 10);
-                    ssd1306_draw_string(&ssd, "Vazio!", 5, 19);
-                    ssd1306_draw_string(&ssd, buffer, 5, 44);
-                    ssd1306_send_data(&ssd);
-                    
-                    printf("Tarefa 2 ativa\n");
-
-                    // Tempo de exibição da mensagem
-                    vTaskDelay(1000 / portTICK_PERIOD_MS);
-
-                    // Tela de espera padrão
-                    ssd1306_fill(&ssd, 0);
-                    ssd1306_draw_string(&ssd, "Aguardando ", 5, 25);
-                    ssd1306_draw_string(&ssd, "  evento...", 5, 34);
-                    ssd1306_send_data(&ssd);
-
-                    xSemaphoreGive(xDisplayMutex);
-                }
-            }
+            saidas_juntar(&proxima, &saida);
+            saida = proxima;
         }
+        aplicar_saida(&saida);
     }
 }
 
-// Função de tratamento de interrupção para os botões
-void gpio_irq_handler(uint gpio, uint32_t events)
+// Grava o log de eventos na flash em páginas inteiras; após PERSIST_ATRASO_MS
+// sem eventos novos grava também a página parcial. As operações de flash
+// suspendem as interrupções, por isso a tarefa tem prioridade mínima.
+void vTaskPersistencia(void *params)
+{
+    while (true)
+    {
+        // Sem nada a gravar a tarefa não acorda até o próximo lote
+        TickType_t espera = persist_pendente() ? pdMS_TO_TICKS(PERSIST_ATRASO_MS) : portMAX_DELAY;
+        bool novos = ulTaskNotifyTake(pdTRUE, espera) != 0;
+        persist_gravar(!novos);
+    }
+}
+
+// Supervisor na maior prioridade: verifica os prazos das etapas a cada
+// SUPERVISOR_PERIODO_MS e só alimenta o watchdog com todas em dia. A etapa
+// de entrada é observada pela fila: ocupada enquanto há evento não retirado,
+// desde a borda do mais antigo. Uma etapa travada de vez leva ao reset, e a
+// contagem volta dos registradores do watchdog.
+void vTaskSupervisor(void *params)
+{
+    static const uint32_t prazos[SUP_ETAPAS] = {
+        [SUP_ENTRADA] = PRAZO_ENTRADA_MS * 1000u,
+        [SUP_LOGICA] = PRAZO_LOGICA_MS * 1000u,
+        [SUP_DISPLAY] = PRAZO_DISPLAY_MS * 1000u,
+    };
+    sup_init(prazos, WATCHDOG_MS);
+    TickType_t ultimo = xTaskGetTickCount();
+
+    while (true)
+    {
+        vTaskDelayUntil(&ultimo, pdMS_TO_TICKS(SUPERVISOR_PERIODO_MS));
+
+        uint32_t tail = filaEventos.tail;
+        sup_fim(SUP_ENTRADA);
+        if (filaEventos.head != tail)
+            sup_inicio(SUP_ENTRADA, filaEventos.itens[tail & (EVENTOS_CAPACIDADE - 1)].timestamp_us);
+
+        sup_verificar();
+    }
+}
+
+// Tarefas criadas pela aplicação e o tamanho de pilha de cada uma
+static struct
+{
+    TaskHandle_t handle;
+    configSTACK_DEPTH_TYPE pilha;
+} tarefas[TAREFAS_MAX];
+static uint8_t total_tarefas;
+
+#if PAINEL_STATIC
+// Memória das tarefas reservada em tempo de compilação (sem heap)
+#define PILHAS_TOTAL \
+    (PILHA_EVENTOS + PILHA_SAIDAS + PILHA_DISPLAY + PILHA_COMANDOS + PILHA_PERSISTENCIA + PILHA_SUPERVISOR)
+static StackType_t pilhas[PILHAS_TOTAL];
+static configSTACK_DEPTH_TYPE pilhas_usadas;
+static StaticTask_t tcbs[TAREFAS_MAX];
+
+static StaticTask_t tcb_idle;
+static StackType_t pilha_idle[configMINIMAL_STACK_SIZE];
+static StaticTask_t tcb_timer;
+static StackType_t pilha_timer[configTIMER_TASK_STACK_DEPTH];
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **pilha, uint32_t *tamanho)
+{
+    *tcb = &tcb_idle;
+    *pilha = pilha_idle;
+    *tamanho = configMINIMAL_STACK_SIZE;
+}
+
+#if configNUMBER_OF_CORES > 1
+static StaticTask_t tcb_idle_passiva[configNUMBER_OF_CORES - 1];
+static StackType_t pilha_idle_passiva[configNUMBER_OF_CORES - 1][configMINIMAL_STACK_SIZE];
+
+void vApplicationGetPassiveIdleTaskMemory(StaticTask_t **tcb, StackType_t **pilha, uint32_t *tamanho, BaseType_t indice)
+{
+    *tcb = &tcb_idle_passiva[indice];
+    *pilha = pilha_idle_passiva[indice];
+    *tamanho = configMINIMAL_STACK_SIZE;
+}
+#endif
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **pilha, uint32_t *tamanho)
+{
+    *tcb = &tcb_timer;
+    *pilha = pilha_timer;
+    *tamanho = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
+
+#if configCHECK_FOR_STACK_OVERFLOW
+void vApplicationStackOverflowHook(TaskHandle_t tarefa, char *nome)
+{
+    panic("Estouro de pilha na tarefa %s", nome);
+}
+#endif
+
+// Cria uma tarefa; no modo SMP ela fica presa aos núcleos indicados
+static void criar_tarefa(TaskFunction_t funcao, const char *nome, configSTACK_DEPTH_TYPE pilha,
+                         UBaseType_t prioridade, UBaseType_t nucleos, TaskHandle_t *handle)
+{
+    configASSERT(total_tarefas < TAREFAS_MAX);
+    TaskHandle_t criada = NULL;
+
+#if PAINEL_STATIC
+    configASSERT(pilhas_usadas + pilha <= PILHAS_TOTAL);
+    StackType_t *memoria = &pilhas[pilhas_usadas];
+    pilhas_usadas += pilha;
+#if PAINEL_SMP
+    criada = xTaskCreateStaticAffinitySet(funcao, nome, pilha, NULL, prioridade, memoria, &tcbs[total_tarefas], nucleos);
+#else
+    (void)nucleos;
+    criada = xTaskCreateStatic(funcao, nome, pilha, NULL, prioridade, memoria, &tcbs[total_tarefas]);
+#endif
+#elif PAINEL_SMP
+    xTaskCreateAffinitySet(funcao, nome, pilha, NULL, prioridade, nucleos, &criada);
+#else
+    (void)nucleos;
+    xTaskCreate(funcao, nome, pilha, NULL, prioridade, &criada);
+#endif
+
+    tarefas[total_tarefas].handle = criada;
+    tarefas[total_tarefas].pilha = pilha;
+    total_tarefas++;
+    if (handle != NULL)
+        *handle = criada;
+}
+
+// Tamanho de pilha (palavras) de uma tarefa; as do kernel usam os valores do FreeRTOSConfig.h
+static configSTACK_DEPTH_TYPE pilha_da_tarefa(TaskHandle_t handle)
+{
+    for (uint8_t i = 0; i < total_tarefas; ++i)
+        if (tarefas[i].handle == handle)
+            return tarefas[i].pilha;
+    if (handle == xTimerGetTimerDaemonTaskHandle())
+        return configTIMER_TASK_STACK_DEPTH;
+    return configMINIMAL_STACK_SIZE; // idle
+}
+
+// Tempo de CPU e menor folga de pilha já registrada de cada tarefa
+static void relatorio_tarefas(void)
+{
+    static TaskStatus_t estados[TAREFAS_MAX + configNUMBER_OF_CORES + 1]; // + idle e timer
+    configRUN_TIME_COUNTER_TYPE total;
+    UBaseType_t n = uxTaskGetSystemState(estados, count_of(estados), &total);
+
+    printf("tarefa        CPU (us)   CPU   pilha   livre min (palavras)\n");
+    for (UBaseType_t i = 0; i < n; ++i)
+    {
+        const TaskStatus_t *t = &estados[i];
+        unsigned percentual = total ? (unsigned)(t->ulRunTimeCounter * 100 / total) : 0;
+        printf("%-10s %11llu %4u%% %7lu %7lu\n", t->pcTaskName,
+               (unsigned long long)t->ulRunTimeCounter, percentual,
+               (unsigned long)pilha_da_tarefa(t->xHandle),
+               (unsigned long)t->usStackHighWaterMark);
+    }
+
+#if PAINEL_STATIC
+    printf("heap do FreeRTOS: nenhum (alocacao estatica)\n");
+#else
+    printf("heap do FreeRTOS: %lu livres, minimo %lu\n",
+           (unsigned long)xPortGetFreeHeapSize(), (unsigned long)xPortGetMinimumEverFreeHeapSize());
+#endif
+}
+
+// Escreve bytes na USB sem a tradução de \n para \r\n
+static void console_escrever(const uint8_t *dados, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+        putchar_raw(dados[i]);
+}
+
+// Envia os quadros de telemetria pendentes de todos os canais
+static void telemetria_drenar(void)
+{
+    static tel_canal_t *const canais[] = {&telEventos, &telDisplay};
+    uint8_t bloco[64];
+
+    for (uint8_t i = 0; i < count_of(canais); ++i)
+    {
+        uint32_t n;
+        while ((n = tel_drenar(canais[i], bloco, sizeof(bloco))) > 0)
+            console_escrever(bloco, n);
+    }
+}
+
+// Envia os contadores de descarte quando algum deles mudou
+static void telemetria_perdas(void)
+{
+    static uint32_t total_anterior;
+    tel_perdas_t perdas = {
+        time_us_32(),
+        filaEventos.perdidos,
+        filaSaidas.perdidos,
+        telEventos.perdidos + telDisplay.perdidos,
+        persist_stats()->perdidos,
+    };
+    uint32_t total = perdas.eventos + perdas.saidas + perdas.telemetria + perdas.flash;
+    if (total == total_anterior)
+        return;
+    total_anterior = total;
+
+    uint8_t quadro[TEL_CONTEUDO_MAX + 4];
+    console_escrever(quadro, tel_montar(quadro, TEL_PERDAS, &perdas, sizeof(perdas)));
+}
+
+// Reproduz um rastro (lib/rastro.h) recebido pelo console: em tempo real ou
+// o mais rápido possível. As linhas vêm logo após o comando e "fim" (ou
+// RASTRO_SILENCIO_US sem dados) encerra. Cada evento entra na fila como se
+// viesse da ISR, com o instante da entrega, e os botões ficam ignorados: as
+// interrupções deles e esta tarefa estão no mesmo núcleo, então a fila
+// continua com um só produtor. A contagem do painel é alterada de verdade;
+// a referência parte da contagem atual.
+static void rastro_reproduzir(bool tempo_real)
+{
+    static ocupacao_t referencia;
+    ocupacao_init(&referencia, zonas, count_of(zonas), portas, count_of(portas));
+
+    // Espera os eventos anteriores serem aplicados antes de copiar a contagem
+    rastro_ativo = true;
+    while (eventos_consumidos != filaEventos.head)
+        vTaskDelay(1);
+    memcpy(referencia.usuarios, usuarios_publicados, sizeof(referencia.usuarios));
+
+    rastro_resultado_t r = {0};
+    uint32_t perdidos = filaEventos.perdidos;
+    uint32_t anterior_us = 0;
+    uint64_t inicio = 0, rastro_us = 0;
+    char linha[RASTRO_LINHA_MAX];
+    uint8_t n = 0;
+
+    while (true)
+    {
+        int c = getchar_timeout_us(RASTRO_SILENCIO_US);
+        if (c == PICO_ERROR_TIMEOUT)
+            break;
+        if (c != '\n' && c != '\r')
+        {
+            if (n < sizeof(linha) - 1)
+                linha[n++] = (char)c;
+            continue;
+        }
+        linha[n] = '\0';
+        n = 0;
+        if (strcmp(linha, "fim") == 0)
+            break;
+
+        evento_t evento;
+        if (!rastro_ler(linha, &evento))
+            continue;
+        if (r.eventos > 0)
+            rastro_us += evento.timestamp_us - anterior_us;
+        anterior_us = evento.timestamp_us;
+
+        if (r.eventos == 0)
+            inicio = time_us_64();
+        else if (tempo_real)
+        {
+            // Dorme os ticks inteiros e completa a espera ativamente
+            uint64_t alvo = inicio + rastro_us;
+            while (alvo > time_us_64() + portTICK_PERIOD_MS * 1000u)
+                vTaskDelay(1);
+            while (alvo > time_us_64())
+                tight_loop_contents();
+        }
+
+        rastro_referencia(&referencia, &evento);
+        evento.timestamp_us = time_us_32();
+        eventos_push(&filaEventos, &evento);
+        xTaskNotifyGive(xTaskEventos);
+        r.eventos++;
+    }
+
+    while (eventos_consumidos != filaEventos.head)
+        vTaskDelay(1);
+    r.duracao_us = r.eventos > 0 ? time_us_64() - inicio : 0;
+    r.perdidos = filaEventos.perdidos - perdidos;
+    rastro_ativo = false;
+
+    rastro_relatorio(&r, &referencia, usuarios_publicados);
+}
+
+// Console USB em prioridade mínima. É a única tarefa que escreve na USB
+// depois do boot, então texto e quadros de telemetria nunca se misturam.
+// Comandos:
+//   l - histogramas de latência   t - CPU e pilha por tarefa   z - zera os histogramas
+//   f - gravações do log na flash  e - CPU ociosa, estado do display e economia estimada
+//   d - barramento e envios do display
+//   r - reproduz um rastro em tempo real   R - o mesmo na velocidade máxima
+//   s - prazos e atrasos das etapas (supervisor)
+void vTaskComandos(void *params)
 {
-    uint32_t current_time = to_ms_since_boot(get_absolute_time());
-    if (current_time - last_time > 200)
+    TickType_t ultimas_perdas = xTaskGetTickCount();
+
+    while (true)
     {
-        // Botão A pressionado - sinaliza tarefa de entrada
-        if (gpio == BOTAO_A)
+        if (display_sem_dma)
         {
-            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-            // Libera o semáforo de entrada a partir da ISR
-            xSemaphoreGiveFromISR(xContadorSemA, &xHigherPriorityTaskWoken);
-            // Solicita troca de contexto se necessário
-            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            display_sem_dma = false;
+            printf("DMA indisponivel, display em modo bloqueante\n");
         }
-        // Botão B pressionado - sinaliza tarefa de saída
-        else if (gpio == BOTAO_B)
+
+        telemetria_drenar();
+        if (xTaskGetTickCount() - ultimas_perdas >= pdMS_TO_TICKS(PERDAS_PERIODO_MS))
+        {
+            ultimas_perdas = xTaskGetTickCount();
+            telemetria_perdas();
+        }
+
+        int c = getchar_timeout_us(0);
+        if (c == PICO_ERROR_TIMEOUT)
+        {
+            // Com o painel desligado o console acorda menos a CPU
+            bool ocioso = energia_display_nivel() == ENERGIA_DESLIGADO;
+            vTaskDelay(pdMS_TO_TICKS(ocioso ? CONSOLE_OCIOSO_MS : CONSOLE_PERIODO_MS));
+            continue;
+        }
+
+        if (c == 'l')
+        {
+            latencia_relatorio();
+        }
+        else if (c == 't')
+        {
+            relatorio_tarefas();
+        }
+        else if (c == 'z')
+        {
+            latencia_zerar();
+        }
+        else if (c == 'f')
+        {
+            const persist_stats_t *st = persist_stats();
+            printf("flash: %lu paginas, %lu setores apagados, %lu eventos perdidos, %lu falhas, %u restaurados\n",
+                   (unsigned long)st->paginas, (unsigned long)st->setores, (unsigned long)st->perdidos,
+                   (unsigned long)st->falhas, st->restaurados);
+        }
+        else if (c == 'e')
+        {
+            energia_relatorio();
+        }
+        else if (c == 'd')
+        {
+            printf("display: I2C %lu Hz, init %lu us, ultimo envio %lu us, %lu bytes poupados, %lu quadros iguais\n",
+                   (unsigned long)ssd.baudrate, (unsigned long)ssd.init_us, (unsigned long)ssd.last_xfer_us,
+                   (unsigned long)ssd.bytes_saved, (unsigned long)ssd.frames_skipped);
+            printf("display: %lu timeouts do barramento, %lu recuperacoes\n", (unsigned long)ssd.timeouts,
+                   (unsigned long)ssd.recoveries);
+        }
+        else if (c == 's')
         {
-            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-            xSemaphoreGiveFromISR(xContadorSemB, &xHigherPriorityTaskWoken);
-            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            sup_relatorio();
         }
-        // Botão do joystick pressionado - sinaliza tarefa de reset
-        else if (gpio == JOYSTICK_BTN_PIN)
+        else if (c == 'r' || c == 'R')
         {
-            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-            xSemaphoreGiveFromISR(xResetSem, &xHigherPriorityTaskWoken);
-            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            rastro_reproduzir(c == 'r');
         }
-        // Atualiza o tempo da última interrupção
-        last_time = current_time;
     }
 }
 
+// Contador de tempo das estatísticas de execução do FreeRTOS
+uint64_t painel_runtime_us(void)
+{
+    return time_us_64();
+}
+
+// Entrega o pressionamento de botoes[i] à tarefa de eventos (contexto de ISR)
+static void botao_pressionado(uint8_t i, uint32_t instante_us)
+{
+    if (rastro_ativo)
+        return; // a fila é da reprodução do rastro
+
+    evento_t evento = {instante_us, botoes[i].tipo, botoes[i].porta};
+    eventos_push(&filaEventos, &evento);
+
+    // Acorda a tarefa de eventos e solicita troca de contexto se necessário
+    if (xTaskEventos != NULL)
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(xTaskEventos, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+#if !PAINEL_BOTOES_PIO
+// Função de tratamento de interrupção para os botões
+void gpio_irq_handler(uint gpio, uint32_t events)
+{
+    uint32_t agora = time_us_32();
+
+    for (uint8_t i = 0; i < count_of(botoes); ++i)
+    {
+        if (botoes[i].pino != gpio)
+            continue;
+
+        // Debounce independente por botão
+        if (agora - botoes[i].ultimo_us < DEBOUNCE_MS * 1000u)
+            return;
+        botoes[i].ultimo_us = agora;
+
+        botao_pressionado(i, agora);
+        return;
+    }
+}
+#endif
+
 int main()
 {
     // Inicializa a saída padrão (UART)
@@ -320,51 +937,46 @@ int main()
     gpio_set_dir(JOYSTICK_BTN_PIN, GPIO_IN);
     gpio_pull_up(JOYSTICK_BTN_PIN);
 
+#if PAINEL_BOTOES_PIO
+    // --- Debounce e carimbo de tempo na PIO: uma interrupção por pressionamento ---
+    uint pinos[count_of(botoes)];
+    for (uint8_t i = 0; i < count_of(botoes); ++i)
+        pinos[i] = botoes[i].pino; // o índice do callback é o de botoes[]
+    botoes_init(pinos, count_of(pinos), DEBOUNCE_PIO_US, botao_pressionado);
+#else
     // --- Configura interrupções para os botões na borda de descida ---
     gpio_set_irq_enabled_with_callback(BOTAO_A, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
     gpio_set_irq_enabled_with_callback(BOTAO_B, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
     gpio_set_irq_enabled_with_callback(JOYSTICK_BTN_PIN, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
+#endif
 
-    // --- Inicializa os LEDs como saída ---
-    gpio_init(LED_PIN_GREEN);
-    gpio_set_dir(LED_PIN_GREEN, GPIO_OUT);
-
-    gpio_init(LED_PIN_BLUE);
-    gpio_set_dir(LED_PIN_BLUE, GPIO_OUT);
-
-    gpio_init(LED_PIN_RED);
-    gpio_set_dir(LED_PIN_RED, GPIO_OUT);
-
-    // --- Garante que todos os LEDs comecem apagados ---
-    gpio_put(LED_PIN_GREEN, false);
-    gpio_put(LED_PIN_BLUE, false);
-    gpio_put(LED_PIN_RED, false);
+    // --- LED RGB de status (começa apagado) ---
+    led_init(LED_PIN_RED, LED_PIN_GREEN, LED_PIN_BLUE);
+    led_brilho(LED_BRILHO);
 
     // Indica estado inicial (sem usuários) com LED azul aceso
-    gpio_put(LED_PIN_BLUE, true);
-
-    // Inicializa o buzzer
-    buzzer_init(BUZZER_PIN);
-
-    // Inicializa o display OLED via I2C
-    initDisplay(&ssd);
-
-    // Mostra mensagem de "aguardando evento" no display
-    ssd1306_fill(&ssd, 0);
-    ssd1306_draw_string(&ssd, "Aguardando ", 5, 25);
-    ssd1306_draw_string(&ssd, "  evento...", 5, 34);
-    ssd1306_send_data(&ssd);
-
-    // --- Criação dos semáforos ---
-    xContadorSemA = xSemaphoreCreateCounting(10, 0); // Para eventos de entrada
-    xContadorSemB = xSemaphoreCreateCounting(10, 0); // Para eventos de saída
-    xResetSem = xSemaphoreCreateBinary();            // Para evento de reset
-    xDisplayMutex = xSemaphoreCreateMutex();         // Protege acesso ao display
+    atualizar_led(OCUPACAO_VAZIO);
+
+    // --- Fila de estados de tela e timer de retorno à tela de espera ---
+#if PAINEL_STATIC
+    static StaticQueue_t fila_tela;
+    static uint8_t fila_tela_dados[sizeof(estado_tela_t)];
+    static StaticTimer_t timer_espera;
+    xTelaQueue = xQueueCreateStatic(1, sizeof(estado_tela_t), fila_tela_dados, &fila_tela);
+    xTimerEspera = xTimerCreateStatic("Espera", pdMS_TO_TICKS(DISPLAY_HOLD_MS), pdFALSE, NULL, vTimerEspera, &timer_espera);
+#else
+    xTelaQueue = xQueueCreate(1, sizeof(estado_tela_t));
+    xTimerEspera = xTimerCreate("Espera", pdMS_TO_TICKS(DISPLAY_HOLD_MS), pdFALSE, NULL, vTimerEspera);
+#endif
 
     // --- Criação das tarefas do FreeRTOS ---
-    xTaskCreate(vTaskEntrada, "Entrada", configMINIMAL_STACK_SIZE + 128, NULL, 1, NULL);
-    xTaskCreate(vTaskSaida, "Saida", configMINIMAL_STACK_SIZE + 128, NULL, 1, NULL);
-    xTaskCreate(vTaskReset, "Reset", configMINIMAL_STACK_SIZE + 128, NULL, 1, NULL);
+    // Entrada e lógica no núcleo 0; display, LED e buzzer no núcleo 1 (modo SMP)
+    criar_tarefa(vTaskEventos, "Eventos", PILHA_EVENTOS, 1, NUCLEO_LOGICA, &xTaskEventos);
+    criar_tarefa(vTaskSaidas, "Saidas", PILHA_SAIDAS, 1, NUCLEO_IO, &xTaskSaidas);
+    criar_tarefa(vTaskDisplay, "Display", PILHA_DISPLAY, 1, NUCLEO_IO, NULL);
+    criar_tarefa(vTaskComandos, "Comandos", PILHA_COMANDOS, tskIDLE_PRIORITY, NUCLEO_LOGICA, NULL);
+    criar_tarefa(vTaskPersistencia, "Persist", PILHA_PERSISTENCIA, tskIDLE_PRIORITY, NUCLEO_LOGICA, &xTaskPersistencia);
+    criar_tarefa(vTaskSupervisor, "Superv", PILHA_SUPERVISOR, 2, NUCLEO_LOGICA, NULL);
 
     // Inicia o escalonador do FreeRTOS
     vTaskStartScheduler();
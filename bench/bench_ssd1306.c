@@ -0,0 +1,259 @@
+// Micro-benchmarks das primitivas de desenho do SSD1306.
+//
+// Cada caso roda uma vez para aquecimento e depois BENCH_REPETICOES vezes,
+// com BENCH_ITERACOES chamadas por repetição. O relatório é uma linha JSON
+// por caso (ns/op mínimo, mediano e máximo), para comparar execuções e
+// detectar regressões no código de rasterização.
+//
+// No RP2040 o tempo vem do timer de 1 MHz sobre lotes grandes e o custo em
+// ciclos é derivado de clk_sys; no host vem de clock_gettime.
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+#include "font.h"
+#include "telas.h"
+#include "moldura.h"     // gerados por imagem_conv a partir de imagens/moldura.pbm
+#include "moldura_rle.h"
+
+#ifdef PAINEL_HOST
+#include <time.h>
+#define BENCH_BACKEND "host"
+#else
+#include "hardware/clocks.h"
+#define BENCH_BACKEND "rp2040"
+#endif
+
+#define BENCH_REPETICOES 7
+#define BENCH_ITERACOES 200
+
+typedef struct
+{
+    const char *nome;
+    uint32_t iteracoes;                      // chamadas por repetição
+    void (*executar)(ssd1306_t *ssd, uint32_t i);
+} bench_caso_t;
+
+static ssd1306_t ssd;
+
+// Relógio do backend em nanossegundos
+static uint64_t bench_agora_ns(void)
+{
+#ifdef PAINEL_HOST
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#else
+    return time_us_64() * 1000u;
+#endif
+}
+
+// Os casos alternam a cor/posição com i para que o buffer mude a cada chamada
+static void bench_fill(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_fill(ssd, i & 1);
+}
+
+static void bench_pixel(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_pixel(ssd, i & 127, (i >> 7) & 63, i & 1);
+}
+
+static void bench_draw_string(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_draw_string(ssd, (i & 1) ? "Usuarios: 8" : "Usuarios: 7", 5, 44);
+}
+
+static void bench_draw_string_desalinhada(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_draw_string(ssd, (i & 1) ? "Usuarios: 8" : "Usuarios: 7", 5, 41);
+}
+
+// Referência: o texto como era desenhado antes, um ssd1306_pixel por bit do
+// glifo (64 por caractere), com a mesma quebra de linha de ssd1306_draw_string
+static void bench_texto_por_pixel(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+{
+    while (*str)
+    {
+        char c = *str++;
+        uint16_t index = (c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0;
+        for (uint8_t i = 0; i < 8; ++i)
+            for (uint8_t j = 0; j < 8; ++j)
+                ssd1306_pixel(ssd, x + i, y + j, font[index + i] & (1 << j));
+        x += 8;
+        if (x + 8 >= ssd->width)
+        {
+            x = 0;
+            y += 8;
+        }
+        if (y + 8 >= ssd->height)
+            break;
+    }
+}
+
+static void bench_draw_string_por_pixel(ssd1306_t *ssd, uint32_t i)
+{
+    bench_texto_por_pixel(ssd, (i & 1) ? "Usuarios: 8" : "Usuarios: 7", 5, 44);
+}
+
+static void bench_line(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_line(ssd, 0, 0, 127, 63, i & 1);
+}
+
+static void bench_hline(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_hline(ssd, 0, 127, i & 63, i & 1);
+}
+
+static void bench_vline(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_vline(ssd, i & 127, 3, 60, i & 1);
+}
+
+static void bench_rect(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_rect(ssd, 3, 3, 122, 58, i & 1, false);
+}
+
+static void bench_rect_fill(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_rect(ssd, 3, 3, 122, 58, i & 1, true);
+}
+
+static void bench_desenhar(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_fill(ssd, 0);
+    desenhar(ssd, &moldura[0]);
+}
+
+// Imagem de tela inteira (moldura e diagonal) sem e com compressão
+static void bench_imagem(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_image(ssd, &moldura[0], i & 1, 0, false);
+}
+
+static void bench_imagem_rle(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_image(ssd, &moldura_rle[0], i & 1, 0, false);
+}
+
+// Troca de tela como era feita: limpar, quatro textos e a contagem com sprintf
+static void bench_tela_texto(ssd1306_t *ssd, uint32_t i)
+{
+    char buffer[32];
+    ssd1306_fill(ssd, 0);
+    sprintf(buffer, "Usuarios: %lu", (unsigned long)(i & 7));
+    ssd1306_draw_string(ssd, (i & 1) ? "Saida " : "Entrada ", 5, 10);
+    ssd1306_draw_string(ssd, "Detectada!", 5, 19);
+    ssd1306_draw_string(ssd, "Sala", 5, 35);
+    ssd1306_draw_string(ssd, buffer, 5, 44);
+}
+
+// A mesma troca com as telas pré-renderizadas
+static void bench_tela_blit(ssd1306_t *ssd, uint32_t i)
+{
+    telas_desenhar(ssd, (i & 1) ? TELA_SAIDA : TELA_ENTRADA, "Sala", i & 7);
+}
+
+// Preparação de uma janela como antes: um comando por transação
+static void bench_janela_por_comando(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_command(ssd, SET_COL_ADDR);
+    ssd1306_command(ssd, i & 63);
+    ssd1306_command(ssd, 127);
+    ssd1306_command(ssd, SET_PAGE_ADDR);
+    ssd1306_command(ssd, 0);
+    ssd1306_command(ssd, 7);
+}
+
+// A mesma janela numa única lista de comandos
+static void bench_janela_lista(ssd1306_t *ssd, uint32_t i)
+{
+    const uint8_t cmds[] = {SET_COL_ADDR, i & 63, 127, SET_PAGE_ADDR, 0, 7};
+    ssd1306_command_list(ssd, cmds, sizeof(cmds));
+}
+
+static void bench_config(ssd1306_t *ssd, uint32_t i)
+{
+    ssd1306_config(ssd);
+}
+
+static const bench_caso_t casos[] = {
+    {"fill", BENCH_ITERACOES, bench_fill},
+    {"pixel", BENCH_ITERACOES * 50, bench_pixel},
+    {"draw_string_per_pixel", BENCH_ITERACOES, bench_draw_string_por_pixel},
+    {"draw_string", BENCH_ITERACOES, bench_draw_string},
+    {"draw_string_unaligned", BENCH_ITERACOES, bench_draw_string_desalinhada},
+    {"line", BENCH_ITERACOES, bench_line},
+    {"hline", BENCH_ITERACOES, bench_hline},
+    {"vline", BENCH_ITERACOES, bench_vline},
+    {"rect", BENCH_ITERACOES, bench_rect},
+    {"rect_fill", BENCH_ITERACOES, bench_rect_fill},
+    {"desenhar", 4, bench_desenhar},
+    {"image", BENCH_ITERACOES, bench_imagem},
+    {"image_rle", BENCH_ITERACOES, bench_imagem_rle},
+    {"screen_text", BENCH_ITERACOES, bench_tela_texto},
+    {"screen_blit", BENCH_ITERACOES, bench_tela_blit},
+    {"window_setup_per_command", BENCH_ITERACOES, bench_janela_por_comando},
+    {"window_setup_list", BENCH_ITERACOES, bench_janela_lista},
+    {"config", BENCH_ITERACOES / 4, bench_config},
+};
+
+// Tempo médio por chamada (ns) de uma repetição
+static uint64_t bench_repeticao(const bench_caso_t *caso)
+{
+    uint64_t inicio = bench_agora_ns();
+    for (uint32_t i = 0; i < caso->iteracoes; ++i)
+        caso->executar(&ssd, i);
+    return (bench_agora_ns() - inicio) / caso->iteracoes;
+}
+
+static void bench_rodar(const bench_caso_t *caso)
+{
+    uint64_t amostras[BENCH_REPETICOES];
+
+    bench_repeticao(caso); // aquecimento
+
+    for (uint8_t r = 0; r < BENCH_REPETICOES; ++r)
+    {
+        uint64_t ns = bench_repeticao(caso);
+        // Inserção ordenada para obter mínimo, mediana e máximo
+        uint8_t j = r;
+        while (j > 0 && amostras[j - 1] > ns)
+        {
+            amostras[j] = amostras[j - 1];
+            --j;
+        }
+        amostras[j] = ns;
+    }
+
+    printf("{\"bench\":\"%s\",\"backend\":\"%s\",\"iter\":%lu,\"reps\":%d,"
+           "\"ns_min\":%llu,\"ns_med\":%llu,\"ns_max\":%llu",
+           caso->nome, BENCH_BACKEND, (unsigned long)caso->iteracoes, BENCH_REPETICOES,
+           (unsigned long long)amostras[0], (unsigned long long)amostras[BENCH_REPETICOES / 2],
+           (unsigned long long)amostras[BENCH_REPETICOES - 1]);
+#ifndef PAINEL_HOST
+    uint64_t hz = clock_get_hz(clk_sys);
+    printf(",\"cycles_med\":%llu", (unsigned long long)(amostras[BENCH_REPETICOES / 2] * hz / 1000000000u));
+#endif
+    printf("}\n");
+}
+
+int main()
+{
+    stdio_init_all();
+#ifndef PAINEL_HOST
+    sleep_ms(3000); // tempo para o terminal USB conectar
+#endif
+
+    initDisplay(&ssd);
+
+    for (size_t i = 0; i < count_of(casos); ++i)
+        bench_rodar(&casos[i]);
+
+    printf("{\"done\":true,\"bytes_saved\":%lu,\"i2c_hz\":%lu,\"init_us\":%lu}\n", (unsigned long)ssd.bytes_saved,
+           (unsigned long)ssd.baudrate, (unsigned long)ssd.init_us);
+    return 0;
+}
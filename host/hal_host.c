@@ -0,0 +1,522 @@
+// Implementação no Linux da camada de hardware usada pelo firmware:
+// tempo, GPIO (com injeção de bordas por roteiro), I2C (modelo do SSD1306),
+// PWM (registro dos tons do buzzer), flash (em RAM, opcionalmente salva em
+// arquivo), watchdog (sem reset) e alarmes (thread dedicada)
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "hardware/flash.h"
+#include "hardware/watchdog.h"
+#include "hal_host.h"
+#include "ssd1306_sim.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------- Tempo
+
+static uint64_t host_agora_us(void)
+{
+    static uint64_t inicio;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t us = (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+    if (inicio == 0)
+        inicio = us;
+    return us - inicio;
+}
+
+absolute_time_t get_absolute_time(void)
+{
+    return host_agora_us();
+}
+
+uint64_t time_us_64(void)
+{
+    return host_agora_us();
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)host_agora_us();
+}
+
+void sleep_us(uint64_t us)
+{
+    struct timespec ts = {(time_t)(us / 1000000u), (long)(us % 1000000u) * 1000};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
+
+void busy_wait_us_32(uint32_t delay_us)
+{
+    uint64_t fim = time_us_64() + delay_us;
+    while (time_us_64() < fim)
+        ;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+// ---------------------------------------------------------------- "Interrupções"
+
+// A única fonte assíncrona no host é a thread dos alarmes
+static pthread_mutex_t host_irq_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+uint32_t save_and_disable_interrupts(void)
+{
+    pthread_mutex_lock(&host_irq_mutex);
+    return 0;
+}
+
+void restore_interrupts(uint32_t status)
+{
+    pthread_mutex_unlock(&host_irq_mutex);
+}
+
+// ---------------------------------------------------------------- Alarmes
+
+typedef struct
+{
+    alarm_id_t id;
+    uint64_t instante_us;
+    alarm_callback_t callback;
+    void *user_data;
+} host_alarme_t;
+
+#define HOST_MAX_ALARMES 16
+
+struct alarm_pool
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    host_alarme_t alarmes[HOST_MAX_ALARMES];
+    uint n;
+    alarm_id_t proximo_id;
+    alarm_id_t disparando; // alarme retirado da lista e aguardando execução
+    bool cancelado;        // o alarme em disparo foi cancelado nesse meio tempo
+};
+
+static void *host_alarm_thread(void *arg)
+{
+    alarm_pool_t *pool = arg;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (true)
+    {
+        if (pool->n == 0)
+        {
+            pthread_cond_wait(&pool->cond, &pool->mutex);
+            continue;
+        }
+
+        uint prox = 0;
+        for (uint i = 1; i < pool->n; ++i)
+            if (pool->alarmes[i].instante_us < pool->alarmes[prox].instante_us)
+                prox = i;
+
+        uint64_t agora = host_agora_us();
+        if (pool->alarmes[prox].instante_us > agora)
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            uint64_t falta = pool->alarmes[prox].instante_us - agora;
+            ts.tv_sec += falta / 1000000u;
+            ts.tv_nsec += (falta % 1000000u) * 1000;
+            if (ts.tv_nsec >= 1000000000)
+            {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&pool->cond, &pool->mutex, &ts);
+            continue;
+        }
+
+        host_alarme_t alarme = pool->alarmes[prox];
+        pool->alarmes[prox] = pool->alarmes[--pool->n];
+        pool->disparando = alarme.id;
+        pool->cancelado = false;
+        pthread_mutex_unlock(&pool->mutex);
+
+        // O callback roda com as "interrupções" desabilitadas, como uma IRQ
+        int64_t reagendar = 0;
+        pthread_mutex_lock(&host_irq_mutex);
+        pthread_mutex_lock(&pool->mutex);
+        bool cancelado = pool->cancelado;
+        pool->disparando = 0;
+        pthread_mutex_unlock(&pool->mutex);
+        if (!cancelado)
+            reagendar = alarme.callback(alarme.id, alarme.user_data);
+        pthread_mutex_unlock(&host_irq_mutex);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (reagendar != 0 && pool->n < HOST_MAX_ALARMES)
+        {
+            // >0: a partir do instante previsto; <0: a partir de agora
+            alarme.instante_us = reagendar > 0 ? alarme.instante_us + (uint64_t)reagendar
+                                               : host_agora_us() + (uint64_t)(-reagendar);
+            pool->alarmes[pool->n++] = alarme;
+        }
+    }
+    return NULL;
+}
+
+alarm_pool_t *alarm_pool_create_with_unused_hardware_alarm(uint max_timers)
+{
+    alarm_pool_t *pool = calloc(1, sizeof(alarm_pool_t));
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    pthread_create(&pool->thread, NULL, host_alarm_thread, pool);
+    return pool;
+}
+
+alarm_id_t alarm_pool_add_alarm_in_us(alarm_pool_t *pool, uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->n >= HOST_MAX_ALARMES)
+    {
+        pthread_mutex_unlock(&pool->mutex);
+        return -1;
+    }
+    if (++pool->proximo_id <= 0)
+        pool->proximo_id = 1;
+    host_alarme_t alarme = {pool->proximo_id, host_agora_us() + us, callback, user_data};
+    pool->alarmes[pool->n++] = alarme;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+    return alarme.id;
+}
+
+alarm_id_t alarm_pool_add_alarm_in_ms(alarm_pool_t *pool, uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    return alarm_pool_add_alarm_in_us(pool, (uint64_t)ms * 1000u, callback, user_data, fire_if_past);
+}
+
+bool alarm_pool_cancel_alarm(alarm_pool_t *pool, alarm_id_t id)
+{
+    bool achou = false;
+    pthread_mutex_lock(&pool->mutex);
+    for (uint i = 0; i < pool->n; ++i)
+    {
+        if (pool->alarmes[i].id == id)
+        {
+            pool->alarmes[i] = pool->alarmes[--pool->n];
+            achou = true;
+            break;
+        }
+    }
+    if (!achou && pool->disparando == id)
+    {
+        pool->cancelado = true;
+        achou = true;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return achou;
+}
+
+// ---------------------------------------------------------------- GPIO
+
+static bool gpio_saida[NUM_BANK0_GPIOS];
+static bool gpio_nivel[NUM_BANK0_GPIOS];
+static uint32_t gpio_irq_eventos[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t gpio_callback;
+
+void gpio_init(uint gpio)
+{
+    gpio_saida[gpio] = false;
+    gpio_nivel[gpio] = false;
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    gpio_saida[gpio] = out;
+}
+
+void gpio_pull_up(uint gpio)
+{
+    if (!gpio_saida[gpio])
+        gpio_nivel[gpio] = true;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    gpio_nivel[gpio] = value;
+}
+
+// Vários pinos numa única chamada, como o registrador GPIO_OUT da SIO
+void gpio_put_masked(uint32_t mask, uint32_t value)
+{
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; ++gpio)
+        if (mask & (1u << gpio))
+            gpio_nivel[gpio] = (value >> gpio) & 1;
+}
+
+void gpio_init_mask(uint32_t mask)
+{
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; ++gpio)
+        if (mask & (1u << gpio))
+            gpio_init(gpio);
+}
+
+void gpio_set_dir_out_masked(uint32_t mask)
+{
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; ++gpio)
+        if (mask & (1u << gpio))
+            gpio_saida[gpio] = true;
+}
+
+bool gpio_get(uint gpio)
+{
+    return gpio_nivel[gpio];
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled)
+{
+    if (enabled)
+        gpio_irq_eventos[gpio] |= events;
+    else
+        gpio_irq_eventos[gpio] &= ~events;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback)
+{
+    gpio_set_irq_enabled(gpio, events, enabled);
+    gpio_callback = callback;
+}
+
+// Simula um botão (pull-up) sendo pressionado: nível baixo e borda de descida
+void host_gpio_irq(uint gpio, uint32_t events)
+{
+    gpio_nivel[gpio] = !(events & GPIO_IRQ_EDGE_FALL);
+    if (gpio_callback != NULL && (gpio_irq_eventos[gpio] & events))
+        gpio_callback(gpio, events & gpio_irq_eventos[gpio]);
+}
+
+// ---------------------------------------------------------------- I2C
+
+i2c_inst_t i2c0_inst = {0}, i2c1_inst = {1};
+static i2c_hw_t host_i2c_hw[2];
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    return baudrate;
+}
+
+void i2c_deinit(i2c_inst_t *i2c)
+{
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    ssd1306_sim_write(addr, src, len);
+    return (int)len;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us)
+{
+    return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c)
+{
+    return &host_i2c_hw[i2c->id];
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx)
+{
+    return 0;
+}
+
+// ---------------------------------------------------------------- PWM
+
+typedef struct
+{
+    uint16_t wrap;
+    uint8_t div;
+    bool ligado;
+} host_pwm_slice_t;
+
+static host_pwm_slice_t pwm_slices[8];
+static uint32_t pwm_tons; // tons iniciados (estatística da simulação)
+
+uint32_t host_pwm_tons(void)
+{
+    return pwm_tons;
+}
+
+uint pwm_gpio_to_slice_num(uint gpio)
+{
+    return (gpio >> 1) & 7;
+}
+
+uint pwm_gpio_to_channel(uint gpio)
+{
+    return gpio & 1;
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap)
+{
+    pwm_slices[slice_num].wrap = wrap;
+}
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract)
+{
+    pwm_slices[slice_num].div = integer;
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level)
+{
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level)
+{
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled)
+{
+    host_pwm_slice_t *s = &pwm_slices[slice_num];
+    if (enabled && !s->ligado)
+    {
+        uint div = s->div ? s->div : 1;
+        pwm_tons++;
+        printf("[%8.3f ms] pwm %u: %u Hz\n", host_agora_us() / 1000.0, slice_num,
+               (unsigned)(125000000u / (div * (s->wrap + 1u))));
+    }
+    s->ligado = enabled;
+}
+
+// ---------------------------------------------------------------- Watchdog
+
+watchdog_hw_t host_watchdog;
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug)
+{
+}
+
+void watchdog_update(void)
+{
+}
+
+// O processo sempre começa de um boot normal
+bool watchdog_caused_reboot(void)
+{
+    return false;
+}
+
+// ---------------------------------------------------------------- Flash
+
+uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+static uint32_t flash_apagamentos[PICO_FLASH_SIZE_BYTES / FLASH_SECTOR_SIZE];
+static int flash_arquivo = -1; // $PAINEL_FLASH: a flash sobrevive entre execuções
+
+// Começa apagada ou com o conteúdo do arquivo
+void host_flash_iniciar(void)
+{
+    memset(host_flash, 0xFF, sizeof(host_flash));
+
+    const char *caminho = getenv("PAINEL_FLASH");
+    if (caminho == NULL)
+        return;
+    flash_arquivo = open(caminho, O_RDWR | O_CREAT, 0644);
+    if (flash_arquivo < 0)
+        panic("flash: nao foi possivel abrir %s", caminho);
+    if (pread(flash_arquivo, host_flash, sizeof(host_flash), 0) != (ssize_t)sizeof(host_flash))
+        pwrite(flash_arquivo, host_flash, sizeof(host_flash), 0);
+}
+
+static void flash_salvar(uint32_t offset, size_t count)
+{
+    if (flash_arquivo >= 0)
+        pwrite(flash_arquivo, &host_flash[offset], count, offset);
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > sizeof(host_flash))
+        panic("flash_range_erase: faixa invalida (%u, %zu)", flash_offs, count);
+    memset(&host_flash[flash_offs], 0xFF, count);
+    for (uint32_t s = flash_offs / FLASH_SECTOR_SIZE; s < (flash_offs + count) / FLASH_SECTOR_SIZE; ++s)
+        flash_apagamentos[s]++;
+    flash_salvar(flash_offs, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > sizeof(host_flash))
+        panic("flash_range_program: faixa invalida (%u, %zu)", flash_offs, count);
+    for (size_t i = 0; i < count; ++i)
+        host_flash[flash_offs + i] &= data[i];
+    flash_salvar(flash_offs, count);
+}
+
+uint32_t host_flash_apagamentos(uint32_t setor)
+{
+    return setor < count_of(flash_apagamentos) ? flash_apagamentos[setor] : 0;
+}
+
+// ---------------------------------------------------------------- stdio, erros e roteiro
+
+int getchar_timeout_us(uint32_t timeout_us)
+{
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    if (poll(&pfd, 1, (int)(timeout_us / 1000)) <= 0)
+        return PICO_ERROR_TIMEOUT;
+    unsigned char c;
+    return read(STDIN_FILENO, &c, 1) == 1 ? c : PICO_ERROR_TIMEOUT;
+}
+
+int putchar_raw(int c)
+{
+    return putchar(c);
+}
+
+void panic(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(1);
+}
+
+void panic_unsupported(void)
+{
+    panic("nao suportado");
+}
+
+// Substituída por host/roteiro.c na simulação completa (com FreeRTOS)
+__attribute__((weak)) void host_roteiro_iniciar(void)
+{
+}
+
+// No host, iniciar o stdio também prepara a simulação: a saída padrão fica
+// sem buffer, a flash simulada e o roteiro de entrada, se houver, são carregados
+bool stdio_init_all(void)
+{
+    setvbuf(stdout, NULL, _IONBF, 0);
+    host_agora_us();
+    host_flash_iniciar();
+    host_roteiro_iniciar();
+    return true;
+}
@@ -0,0 +1,13 @@
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include "pico/stdlib.h"
+
+// Funções exclusivas da simulação (não existem na pico-sdk)
+void host_gpio_irq(uint gpio, uint32_t events); // entrega uma borda ao callback registrado
+uint32_t host_pwm_tons(void);                   // tons iniciados no PWM
+void host_roteiro_iniciar(void);                // carrega o roteiro de entrada ($PAINEL_ROTEIRO)
+void host_flash_iniciar(void);                  // carrega a flash simulada ($PAINEL_FLASH)
+uint32_t host_flash_apagamentos(uint32_t setor); // vezes que o setor foi apagado
+
+#endif
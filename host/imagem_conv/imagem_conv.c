@@ -0,0 +1,276 @@
+// Conversor de imagens para o formato 1bpp do SSD1306 (ssd1306_image_t).
+//
+// Entrada: PBM (P1 ou P4, bit 1 = pixel aceso) ou a exportação em C do
+// Piskel (pixel aceso = alfa 0xFF, como em desenhar), com um ou mais quadros.
+// Saída: um cabeçalho com os bytes coluna a coluna, um por página (bit 0 em
+// cima), como no buffer do display, e um ssd1306_image_t por quadro:
+//
+//   static const ssd1306_image_t nome[NOME_QUADROS];
+//
+// Com -r cada quadro é comprimido em RLE quando isso reduz o tamanho:
+// controle 0..127 = 1..128 bytes literais em seguida; 128..255 = o próximo
+// byte repetido 3..130 vezes.
+//
+//   imagem_conv [-r] nome entrada.pbm saida.h
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LARGURA_MAX 128
+#define ALTURA_MAX 64
+#define QUADROS_MAX 64
+#define RLE_LITERAL_MAX 128
+#define RLE_REPETICAO_MIN 3
+#define RLE_REPETICAO_MAX 130
+
+typedef struct
+{
+    unsigned largura, altura, quadros;
+    uint8_t pixels[QUADROS_MAX][ALTURA_MAX][LARGURA_MAX];
+} imagem_t;
+
+static imagem_t imagem;
+
+static char *ler_arquivo(const char *caminho, size_t *tamanho)
+{
+    FILE *f = fopen(caminho, "rb");
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *dados = malloc(n + 1);
+    if (dados && fread(dados, 1, n, f) != (size_t)n)
+    {
+        free(dados);
+        dados = NULL;
+    }
+    fclose(f);
+    if (dados)
+    {
+        dados[n] = '\0';
+        *tamanho = n;
+    }
+    return dados;
+}
+
+// Próximo número decimal do cabeçalho PBM, pulando espaços e comentários
+static const char *pbm_numero(const char *p, const char *fim, unsigned *valor)
+{
+    while (p < fim && (isspace((unsigned char)*p) || *p == '#'))
+    {
+        if (*p == '#')
+            while (p < fim && *p != '\n')
+                ++p;
+        else
+            ++p;
+    }
+    if (p >= fim || !isdigit((unsigned char)*p))
+        return NULL;
+    *valor = (unsigned)strtoul(p, (char **)&p, 10);
+    return p;
+}
+
+static const char *ler_pbm(const char *dados, size_t tamanho)
+{
+    const char *fim = dados + tamanho;
+    bool binario = dados[1] == '4';
+    const char *p = pbm_numero(dados + 2, fim, &imagem.largura);
+    if (p)
+        p = pbm_numero(p, fim, &imagem.altura);
+    if (!p)
+        return "cabecalho PBM invalido";
+    imagem.quadros = 1;
+
+    if (binario)
+    {
+        ++p; // um espaço separa o cabeçalho dos dados
+        unsigned linha = (imagem.largura + 7) / 8;
+        if ((size_t)(fim - p) < (size_t)linha * imagem.altura)
+            return "PBM truncado";
+        for (unsigned y = 0; y < imagem.altura && y < ALTURA_MAX; ++y)
+            for (unsigned x = 0; x < imagem.largura && x < LARGURA_MAX; ++x)
+                imagem.pixels[0][y][x] = (p[y * linha + x / 8] >> (7 - x % 8)) & 1;
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < imagem.largura * imagem.altura; ++i)
+    {
+        while (p < fim && *p != '0' && *p != '1')
+            ++p;
+        if (p >= fim)
+            return "PBM truncado";
+        unsigned x = i % imagem.largura, y = i / imagem.largura;
+        if (x < LARGURA_MAX && y < ALTURA_MAX)
+            imagem.pixels[0][y][x] = *p == '1';
+        ++p;
+    }
+    return NULL;
+}
+
+// Valor do #define terminado em sufixo (ex.: NEW_PISKEL_FRAME_WIDTH)
+static bool piskel_define(const char *dados, const char *sufixo, unsigned *valor)
+{
+    const char *p = strstr(dados, sufixo);
+    if (!p)
+        return false;
+    *valor = (unsigned)strtoul(p + strlen(sufixo), NULL, 0);
+    return true;
+}
+
+static const char *ler_piskel(const char *dados)
+{
+    if (!piskel_define(dados, "_FRAME_WIDTH", &imagem.largura) ||
+        !piskel_define(dados, "_FRAME_HEIGHT", &imagem.altura))
+        return "exportacao do Piskel sem _FRAME_WIDTH/_FRAME_HEIGHT";
+    if (!piskel_define(dados, "_FRAME_COUNT", &imagem.quadros))
+        imagem.quadros = 1;
+
+    const char *p = strstr(dados, "= {");
+    if (!p)
+        return "exportacao do Piskel sem dados";
+    unsigned total = imagem.largura * imagem.altura;
+    for (unsigned q = 0; q < imagem.quadros; ++q)
+        for (unsigned i = 0; i < total; ++i)
+        {
+            p = strstr(p, "0x");
+            if (!p)
+                return "exportacao do Piskel truncada";
+            uint32_t argb = (uint32_t)strtoul(p, (char **)&p, 16);
+            unsigned x = i % imagem.largura, y = i / imagem.largura;
+            if (q < QUADROS_MAX && x < LARGURA_MAX && y < ALTURA_MAX)
+                imagem.pixels[q][y][x] = argb >= 0xff000000u;
+        }
+    return NULL;
+}
+
+// Bytes do quadro no formato do buffer: coluna a coluna, um byte por página
+static size_t empacotar(unsigned q, uint8_t *saida)
+{
+    unsigned paginas = (imagem.altura + 7) / 8;
+    size_t n = 0;
+    for (unsigned x = 0; x < imagem.largura; ++x)
+        for (unsigned p = 0; p < paginas; ++p)
+        {
+            uint8_t byte = 0;
+            for (unsigned b = 0; b < 8; ++b)
+                if (p * 8 + b < imagem.altura && imagem.pixels[q][p * 8 + b][x])
+                    byte |= 1u << b;
+            saida[n++] = byte;
+        }
+    return n;
+}
+
+static size_t comprimir(const uint8_t *dados, size_t n, uint8_t *saida)
+{
+    size_t i = 0, m = 0;
+    while (i < n)
+    {
+        size_t rep = 1;
+        while (i + rep < n && dados[i + rep] == dados[i] && rep < RLE_REPETICAO_MAX)
+            ++rep;
+        if (rep >= RLE_REPETICAO_MIN)
+        {
+            saida[m++] = (uint8_t)(0x80 + rep - RLE_REPETICAO_MIN);
+            saida[m++] = dados[i];
+            i += rep;
+            continue;
+        }
+
+        // Literais até a próxima repetição que valha a pena
+        size_t inicio = i, lit = 0;
+        while (i < n && lit < RLE_LITERAL_MAX)
+        {
+            if (i + 2 < n && dados[i] == dados[i + 1] && dados[i] == dados[i + 2])
+                break;
+            ++i;
+            ++lit;
+        }
+        saida[m++] = (uint8_t)(lit - 1);
+        memcpy(&saida[m], &dados[inicio], lit);
+        m += lit;
+    }
+    return m;
+}
+
+int main(int argc, char **argv)
+{
+    bool rle = argc > 1 && strcmp(argv[1], "-r") == 0;
+    if (argc != 4 + rle)
+    {
+        fprintf(stderr, "uso: %s [-r] nome entrada saida.h\n", argv[0]);
+        return 2;
+    }
+    const char *nome = argv[1 + rle], *entrada = argv[2 + rle], *saida = argv[3 + rle];
+
+    size_t tamanho;
+    char *dados = ler_arquivo(entrada, &tamanho);
+    if (!dados)
+    {
+        perror(entrada);
+        return 1;
+    }
+    const char *erro = (tamanho > 2 && dados[0] == 'P' && (dados[1] == '1' || dados[1] == '4'))
+                           ? ler_pbm(dados, tamanho)
+                           : ler_piskel(dados);
+    free(dados);
+    if (!erro && (imagem.largura == 0 || imagem.largura > LARGURA_MAX || imagem.altura == 0 ||
+                  imagem.altura > ALTURA_MAX || imagem.quadros == 0 || imagem.quadros > QUADROS_MAX))
+        erro = "dimensoes fora do display (128x64, ate 64 quadros)";
+    if (erro)
+    {
+        fprintf(stderr, "%s: %s\n", entrada, erro);
+        return 1;
+    }
+
+    FILE *f = fopen(saida, "w");
+    if (!f)
+    {
+        perror(saida);
+        return 1;
+    }
+
+    char maiusculo[64];
+    size_t i;
+    for (i = 0; nome[i] && i + 1 < sizeof(maiusculo); ++i)
+        maiusculo[i] = (char)toupper((unsigned char)nome[i]);
+    maiusculo[i] = '\0';
+
+    unsigned paginas = (imagem.altura + 7) / 8;
+    fprintf(f, "// Gerado por imagem_conv a partir de %s; não editar.\n", entrada);
+    fprintf(f, "#pragma once\n#include \"ssd1306.h\"\n\n#define %s_QUADROS %u\n\n", maiusculo, imagem.quadros);
+
+    static uint8_t bruto[LARGURA_MAX * ALTURA_MAX / 8], comprimido[LARGURA_MAX * ALTURA_MAX / 8 * 2];
+    size_t tamanhos[QUADROS_MAX];
+    bool comprimidos[QUADROS_MAX];
+    size_t total = 0;
+    for (unsigned q = 0; q < imagem.quadros; ++q)
+    {
+        size_t n = empacotar(q, bruto);
+        size_t m = rle ? comprimir(bruto, n, comprimido) : n;
+        comprimidos[q] = m < n;
+        const uint8_t *bytes = comprimidos[q] ? comprimido : bruto;
+        tamanhos[q] = comprimidos[q] ? m : n;
+        total += tamanhos[q];
+
+        fprintf(f, "static const uint8_t %s_dados_%u[%zu] = {", nome, q, tamanhos[q]);
+        for (size_t b = 0; b < tamanhos[q]; ++b)
+            fprintf(f, "%s0x%02X,", b % 16 ? " " : "\n    ", bytes[b]);
+        fprintf(f, "\n};\n\n");
+    }
+
+    fprintf(f, "static const ssd1306_image_t %s[%s_QUADROS] = {\n", nome, maiusculo);
+    for (unsigned q = 0; q < imagem.quadros; ++q)
+        fprintf(f, "    {%u, %u, %s, %zu, %s_dados_%u},\n", imagem.largura, paginas,
+                comprimidos[q] ? "SSD1306_IMAGE_RLE" : "0", tamanhos[q], nome, q);
+    fprintf(f, "};\n");
+    fclose(f);
+
+    printf("%s: %ux%u, %u quadro(s), %zu bytes (ARGB: %zu)\n", nome, imagem.largura, imagem.altura, imagem.quadros,
+           total, (size_t)imagem.largura * imagem.altura * imagem.quadros * 4);
+    return 0;
+}
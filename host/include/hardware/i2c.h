@@ -0,0 +1,36 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+// I2C simulado: as escritas são entregues ao modelo do SSD1306 (host/ssd1306_sim.c)
+typedef struct i2c_inst
+{
+    uint id;
+} i2c_inst_t;
+
+// Registradores usados pelo envio por DMA do driver (nunca acionado no host)
+typedef struct
+{
+    volatile uint32_t con, tar, data_cmd, status, enable, raw_intr_stat, clr_tx_abrt;
+} i2c_hw_t;
+
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400u
+#define I2C_IC_STATUS_ACTIVITY_BITS 0x00000001u
+#define I2C_IC_STATUS_TFE_BITS 0x00000004u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+// "Desabilitar interrupções" no host exclui a thread dos alarmes
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+static inline void __dmb(void) { __sync_synchronize(); }
+
+#endif
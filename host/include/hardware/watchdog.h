@@ -0,0 +1,20 @@
+#ifndef HOST_HARDWARE_WATCHDOG_H
+#define HOST_HARDWARE_WATCHDOG_H
+
+#include "pico/stdlib.h"
+
+// Watchdog simulado: nunca reinicia o processo; os registradores de
+// rascunho são memória comum e não sobrevivem entre execuções
+typedef struct
+{
+    volatile uint32_t scratch[8];
+} watchdog_hw_t;
+
+extern watchdog_hw_t host_watchdog;
+#define watchdog_hw (&host_watchdog)
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+bool watchdog_caused_reboot(void);
+
+#endif
@@ -0,0 +1,164 @@
+// Reprodução de um rastro de eventos (lib/rastro.h) contra a lógica de
+// ocupação, com a mesma fila e o mesmo consumo em lotes do firmware.
+//
+// A linha principal faz o papel da ISR: entrega cada evento à fila no
+// instante do rastro (tempo real, acelerado por -x) ou o mais rápido possível
+// (-m). Uma thread faz o papel da tarefa de eventos. Ao final imprime a vazão
+// sustentada, os eventos perdidos com a fila cheia e a contagem de cada zona
+// contra a referência (o rastro aplicado evento a evento). Sai com 1 se a
+// contagem divergir.
+//
+// Com -m o produtor não tem o ritmo dos botões: ele espera enquanto a fila
+// está cheia, e as esperas são relatadas à parte, para que a vazão medida
+// seja a do consumidor e não a perda por excesso do produtor.
+//
+//   ./rastro [-m] [-x fator] rastro.txt
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "eventos.h"
+#include "ocupacao.h"
+#include "rastro.h"
+#include "zonas.h"
+
+static eventos_fila_t fila;
+static sem_t aviso;            // vTaskNotifyGiveFromISR
+static volatile bool terminou; // a produção acabou
+static ocupacao_t ocupacao;    // só a thread consumidora modifica
+static uint64_t ultimo_us;     // fim do último lote
+
+static uint64_t agora_us(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000u + t.tv_nsec / 1000u;
+}
+
+// Equivalente a vTaskEventos: esvazia a fila em lotes de até EVENTOS_CAPACIDADE
+static void *consumidor(void *arg)
+{
+    static evento_t lote[EVENTOS_CAPACIDADE];
+    ocupacao_saida_t saida;
+
+    while (true)
+    {
+        // Como ulTaskNotifyTake(pdTRUE): os avisos acumulados valem por um
+        if (eventos_pendentes(&fila) == 0)
+        {
+            if (terminou)
+                return NULL;
+            sem_wait(&aviso);
+            while (sem_trywait(&aviso) == 0)
+                ;
+        }
+
+        uint8_t n = 0;
+        while (n < EVENTOS_CAPACIDADE && eventos_pop(&fila, &lote[n]))
+            n++;
+        if (n == 0)
+            continue;
+        ocupacao_processar(&ocupacao, lote, n, &saida);
+        ultimo_us = agora_us();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool maxima = false;
+    double fator = 1.0;
+    int i = 1;
+    for (; i < argc - 1; ++i)
+    {
+        if (strcmp(argv[i], "-m") == 0)
+            maxima = true;
+        else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc - 1)
+            fator = atof(argv[++i]);
+        else
+            break;
+    }
+    if (i != argc - 1 || fator <= 0)
+    {
+        fprintf(stderr, "uso: %s [-m] [-x fator] rastro.txt\n", argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(argv[i], "r");
+    if (!f)
+    {
+        perror(argv[i]);
+        return 1;
+    }
+
+    ocupacao_t referencia;
+    if (!ocupacao_init(&ocupacao, zonas, count_of(zonas), portas, count_of(portas)) ||
+        !ocupacao_init(&referencia, zonas, count_of(zonas), portas, count_of(portas)))
+    {
+        fprintf(stderr, "configuracao de zonas/portas invalida\n");
+        return 1;
+    }
+
+    sem_init(&aviso, 0, 0);
+    pthread_t thread;
+    pthread_create(&thread, NULL, consumidor, NULL);
+
+    rastro_resultado_t r = {0};
+    char linha[128];
+    evento_t evento;
+    uint32_t anterior_us = 0;
+    uint64_t rastro_us = 0, inicio = 0;
+    uint32_t esperas = 0; // -m: eventos que encontraram a fila cheia
+
+    while (fgets(linha, sizeof(linha), f) != NULL)
+    {
+        if (!rastro_ler(linha, &evento))
+            continue;
+
+        // Instante relativo ao primeiro evento; a diferença em 32 bits atravessa a volta do contador
+        if (r.eventos > 0)
+            rastro_us += evento.timestamp_us - anterior_us;
+        anterior_us = evento.timestamp_us;
+
+        if (r.eventos == 0)
+            inicio = agora_us();
+        else if (!maxima)
+        {
+            uint64_t alvo = inicio + (uint64_t)(rastro_us / fator);
+            uint64_t t = agora_us();
+            if (alvo > t)
+            {
+                struct timespec espera = {(alvo - t) / 1000000u, (alvo - t) % 1000000u * 1000u};
+                nanosleep(&espera, NULL);
+            }
+        }
+
+        // Sem o ritmo do rastro o produtor espera o consumidor liberar espaço
+        if (maxima && eventos_pendentes(&fila) >= EVENTOS_CAPACIDADE)
+        {
+            esperas++;
+            while (eventos_pendentes(&fila) >= EVENTOS_CAPACIDADE)
+                sched_yield();
+        }
+
+        eventos_push(&fila, &evento);
+        sem_post(&aviso);
+        rastro_referencia(&referencia, &evento);
+        r.eventos++;
+    }
+    fclose(f);
+
+    terminou = true;
+    sem_post(&aviso);
+    pthread_join(thread, NULL);
+
+    r.perdidos = fila.perdidos;
+    r.duracao_us = r.eventos > 0 ? ultimo_us - inicio : 0;
+    if (maxima)
+        printf("rastro: produtor esperou a fila em %u evento(s)\n", esperas);
+    return rastro_relatorio(&r, &referencia, ocupacao.usuarios) ? 0 : 1;
+}
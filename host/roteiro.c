@@ -0,0 +1,54 @@
+// Roteiro de entrada da simulação completa (depende do FreeRTOS)
+
+#include "pico/stdlib.h"
+#include "hal_host.h"
+#include "ssd1306_sim.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+// Roteiro de entrada ($PAINEL_ROTEIRO): uma linha por borda, "<espera_ms> <pino>",
+// '#' inicia comentário. Ao final a simulação aguarda $PAINEL_FIM_MS (padrão
+// 2000 ms), imprime as estatísticas e termina.
+static void vTaskRoteiro(void *params)
+{
+    FILE *f = params;
+    char linha[128];
+
+    while (fgets(linha, sizeof(linha), f) != NULL)
+    {
+        unsigned espera, pino;
+        char *comentario = strchr(linha, '#');
+        if (comentario != NULL)
+            *comentario = '\0';
+        if (sscanf(linha, "%u %u", &espera, &pino) != 2 || pino >= NUM_BANK0_GPIOS)
+            continue;
+        vTaskDelay(pdMS_TO_TICKS(espera));
+        host_gpio_irq(pino, GPIO_IRQ_EDGE_FALL);
+    }
+    fclose(f);
+
+    const char *fim = getenv("PAINEL_FIM_MS");
+    vTaskDelay(pdMS_TO_TICKS(fim != NULL ? atoi(fim) : 2000));
+
+    const ssd1306_sim_stats_t *st = ssd1306_sim_stats();
+    printf("simulacao: %lu quadros, %lu bytes de dados, %lu bytes I2C em %lu transacoes, %lu tons\n",
+           (unsigned long)st->quadros, (unsigned long)st->bytes_dados, (unsigned long)st->bytes_i2c,
+           (unsigned long)st->transacoes, (unsigned long)host_pwm_tons());
+    fflush(stdout);
+    exit(0);
+}
+
+// Cria a tarefa do roteiro quando $PAINEL_ROTEIRO estiver definido
+void host_roteiro_iniciar(void)
+{
+    const char *roteiro = getenv("PAINEL_ROTEIRO");
+    if (roteiro == NULL)
+        return;
+
+    FILE *f = fopen(roteiro, "r");
+    if (f == NULL)
+        panic("roteiro %s nao encontrado", roteiro);
+    xTaskCreate(vTaskRoteiro, "Roteiro", configMINIMAL_STACK_SIZE * 4, f, 2, NULL);
+}
@@ -0,0 +1,199 @@
+#include "ssd1306_sim.h"
+#include <stdio.h>
+#include <string.h>
+
+// GDDRAM no mesmo layout do ram_buffer do driver: coluna * páginas + página
+static uint8_t gddram[SSD1306_SIM_WIDTH * SSD1306_SIM_PAGES];
+static uint8_t col0 = 0, col1 = SSD1306_SIM_WIDTH - 1;
+static uint8_t page0 = 0, page1 = SSD1306_SIM_PAGES - 1;
+static uint8_t col, page;
+static uint8_t modo_enderecamento = 0x02; // padrão do SSD1306: endereçamento por página
+static uint8_t contraste = 0x7F;
+static bool ligado = false;
+static ssd1306_sim_stats_t stats;
+
+// Comando em andamento e os argumentos que ainda faltam
+static uint8_t cmd_atual;
+static uint8_t cmd_args[2];
+static uint8_t cmd_recebidos, cmd_esperados;
+
+// Quantidade de argumentos de cada comando usado pelo driver
+static uint8_t ssd1306_sim_argumentos(uint8_t cmd)
+{
+    switch (cmd)
+    {
+    case 0x21: // SET_COL_ADDR
+    case 0x22: // SET_PAGE_ADDR
+        return 2;
+    case 0x20: // SET_MEM_ADDR
+    case 0x81: // SET_CONTRAST
+    case 0xA8: // SET_MUX_RATIO
+    case 0xD3: // SET_DISP_OFFSET
+    case 0xDA: // SET_COM_PIN_CFG
+    case 0xD5: // SET_DISP_CLK_DIV
+    case 0xD9: // SET_PRECHARGE
+    case 0xDB: // SET_VCOM_DESEL
+    case 0x8D: // SET_CHARGE_PUMP
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void ssd1306_sim_executar(void)
+{
+    switch (cmd_atual)
+    {
+    case 0x21:
+        col0 = cmd_args[0] & 0x7F;
+        col1 = cmd_args[1] & 0x7F;
+        col = col0;
+        break;
+    case 0x22:
+        page0 = cmd_args[0] & 0x07;
+        page1 = cmd_args[1] & 0x07;
+        page = page0;
+        break;
+    case 0x20:
+        modo_enderecamento = cmd_args[0] & 0x03;
+        break;
+    case 0x81:
+        contraste = cmd_args[0];
+        break;
+    case 0xAE:
+    case 0xAF:
+        ligado = cmd_atual & 0x01;
+        break;
+    default:
+        break;
+    }
+}
+
+static void ssd1306_sim_comando(uint8_t byte)
+{
+    if (cmd_esperados > cmd_recebidos)
+    {
+        cmd_args[cmd_recebidos++] = byte;
+    }
+    else
+    {
+        cmd_atual = byte;
+        cmd_recebidos = 0;
+        cmd_esperados = ssd1306_sim_argumentos(byte);
+    }
+    if (cmd_recebidos == cmd_esperados)
+    {
+        ssd1306_sim_executar();
+        cmd_esperados = 0;
+    }
+}
+
+// Grava um byte na GDDRAM e avança o ponteiro conforme o modo de endereçamento
+static void ssd1306_sim_dado(uint8_t byte)
+{
+    gddram[col * SSD1306_SIM_PAGES + page] = byte;
+    stats.bytes_dados++;
+
+    if (modo_enderecamento == 0x01) // vertical: páginas primeiro
+    {
+        if (page++ >= page1)
+        {
+            page = page0;
+            col = (col >= col1) ? col0 : col + 1;
+        }
+    }
+    else // horizontal (e página, tratado como horizontal)
+    {
+        if (col++ >= col1)
+        {
+            col = col0;
+            page = (page >= page1) ? page0 : page + 1;
+        }
+    }
+}
+
+// Uma transação I2C: sequência de bytes de controle (Co, D/C) e conteúdo
+void ssd1306_sim_write(uint8_t addr, const uint8_t *src, size_t len)
+{
+    bool teve_dados = false;
+    size_t i = 0;
+
+    stats.transacoes++;
+    stats.bytes_i2c += len + 1; // inclui o byte de endereço
+
+    while (i < len)
+    {
+        uint8_t controle = src[i++];
+        bool continua = controle & 0x80; // Co: apenas um byte segue este controle
+        bool dado = controle & 0x40;     // D/C
+
+        do
+        {
+            if (i >= len)
+                break;
+            if (dado)
+            {
+                ssd1306_sim_dado(src[i++]);
+                teve_dados = true;
+            }
+            else
+            {
+                ssd1306_sim_comando(src[i++]);
+            }
+        } while (!continua);
+    }
+
+    if (teve_dados)
+    {
+        stats.quadros++;
+        const char *dir = getenv("PAINEL_PBM_DIR");
+        if (dir != NULL)
+        {
+            char caminho[512];
+            snprintf(caminho, sizeof(caminho), "%s/quadro_%05lu.pbm", dir, (unsigned long)stats.quadros);
+            ssd1306_sim_salvar_pbm(caminho);
+        }
+    }
+}
+
+const uint8_t *ssd1306_sim_gddram(void)
+{
+    return gddram;
+}
+
+bool ssd1306_sim_ligado(void)
+{
+    return ligado;
+}
+
+uint8_t ssd1306_sim_contraste(void)
+{
+    return contraste;
+}
+
+const ssd1306_sim_stats_t *ssd1306_sim_stats(void)
+{
+    return &stats;
+}
+
+// Salva a GDDRAM como PBM binário (P4), 1 = pixel aceso
+bool ssd1306_sim_salvar_pbm(const char *caminho)
+{
+    FILE *f = fopen(caminho, "wb");
+    if (f == NULL)
+        return false;
+
+    fprintf(f, "P4\n%d %d\n", SSD1306_SIM_WIDTH, SSD1306_SIM_PAGES * 8);
+    for (int y = 0; y < SSD1306_SIM_PAGES * 8; ++y)
+    {
+        uint8_t linha[SSD1306_SIM_WIDTH / 8] = {0};
+        for (int x = 0; x < SSD1306_SIM_WIDTH; ++x)
+        {
+            if (gddram[x * SSD1306_SIM_PAGES + (y >> 3)] & (1 << (y & 7)))
+                linha[x >> 3] |= 0x80 >> (x & 7);
+        }
+        fwrite(linha, 1, sizeof(linha), f);
+    }
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef SSD1306_SIM_H
+#define SSD1306_SIM_H
+
+#include "pico/stdlib.h"
+
+// Modelo do SSD1306 para a simulação: interpreta as transações I2C do driver
+// (comandos e dados), mantém a GDDRAM e grava cada quadro como imagem PBM
+// em $PAINEL_PBM_DIR quando essa variável estiver definida
+
+#define SSD1306_SIM_WIDTH 128
+#define SSD1306_SIM_PAGES 8
+
+typedef struct
+{
+    uint32_t quadros;     // transações de dados recebidas
+    uint32_t bytes_dados; // bytes de GDDRAM recebidos
+    uint32_t bytes_i2c;   // total de bytes no barramento (com controle e comandos)
+    uint32_t transacoes;  // transações I2C
+} ssd1306_sim_stats_t;
+
+void ssd1306_sim_write(uint8_t addr, const uint8_t *src, size_t len);
+const uint8_t *ssd1306_sim_gddram(void);
+bool ssd1306_sim_ligado(void);
+uint8_t ssd1306_sim_contraste(void);
+const ssd1306_sim_stats_t *ssd1306_sim_stats(void);
+bool ssd1306_sim_salvar_pbm(const char *caminho);
+
+#endif
@@ -0,0 +1,187 @@
+// Decodificador da telemetria binária do painel (lib/telemetria.h).
+//
+// Lê da entrada padrão o fluxo da USB (ou da simulação) e escreve uma linha
+// de texto por quadro. Bytes fora de quadros são texto do console e passam
+// sem alteração. Quadros com tamanho ou verificação inválidos são contados,
+// e a leitura volta a procurar TEL_SINC no byte seguinte ao descartado.
+//
+//   cat /dev/ttyACM0 | ./telemetria_dec
+//
+// Com -r os eventos (TEL_EVENTO, com o instante da ISR) também são gravados
+// como rastro (lib/rastro.h) para reprodução pelo host/rastro ou pelo
+// comando r do console:
+//
+//   cat /dev/ttyACM0 | ./telemetria_dec -r rastro.txt
+
+#include <stdio.h>
+#include <string.h>
+#include "telemetria.h"
+#include "ocupacao.h"
+#include "rastro.h"
+
+static FILE *rastro; // -r: eventos gravados como rastro
+static uint32_t rastro_eventos;
+
+static const char *nome_resultado[] = {
+    [OCUPACAO_RES_ENTRADA] = "entrada",
+    [OCUPACAO_RES_SAIDA] = "saida",
+    [OCUPACAO_RES_LOTADO] = "negada",
+    [OCUPACAO_RES_VAZIO] = "vazia",
+    [OCUPACAO_RES_RESET] = "reset",
+};
+
+static const char *nome_evento(uint8_t tipo)
+{
+    static const char *nomes[] = {[EVENTO_ENTRADA] = "entrada", [EVENTO_SAIDA] = "saida", [EVENTO_RESET] = "reset"};
+    return tipo < count_of(nomes) ? nomes[tipo] : "?";
+}
+
+static void imprimir(uint8_t tipo, const uint8_t *conteudo, uint8_t n)
+{
+    switch (tipo)
+    {
+    case TEL_EVENTO:
+    {
+        tel_evento_t e;
+        if (n != sizeof(e))
+            break;
+        memcpy(&e, conteudo, n);
+        printf("[%10u] evento %s porta=%u latencia=%uus\n", e.timestamp_us, nome_evento(e.tipo), e.porta, e.latencia_us);
+        if (rastro)
+        {
+            evento_t evento = {e.timestamp_us, e.tipo, e.porta};
+            char linha[RASTRO_LINHA_MAX];
+            rastro_formatar(linha, sizeof(linha), &evento);
+            fputs(linha, rastro);
+            rastro_eventos++;
+        }
+        return;
+    }
+    case TEL_LOTE:
+    {
+        tel_lote_t l;
+        if (n != sizeof(l))
+            break;
+        memcpy(&l, conteudo, n);
+        printf("[%10u] lote eventos=%u zona=%u usuarios=%u ultimo=%s%s%s\n", l.timestamp_us, l.eventos, l.zona,
+               l.usuarios, l.resultado < count_of(nome_resultado) ? nome_resultado[l.resultado] : "?",
+               (l.avisos & TEL_LOTE_LOTADO) ? " lotado" : "", (l.avisos & TEL_LOTE_RESET) ? " reset" : "");
+        return;
+    }
+    case TEL_QUADRO:
+    {
+        tel_quadro_t q;
+        if (n != sizeof(q))
+            break;
+        memcpy(&q, conteudo, n);
+        printf("[%10u] quadro tela=%u envio=%uus poupados=%u iguais=%u\n", q.timestamp_us, q.tela, q.envio_us,
+               q.bytes_poupados, q.quadros_iguais);
+        return;
+    }
+    case TEL_PERDAS:
+    {
+        tel_perdas_t p;
+        if (n != sizeof(p))
+            break;
+        memcpy(&p, conteudo, n);
+        printf("[%10u] perdas eventos=%u saidas=%u telemetria=%u flash=%u\n", p.timestamp_us, p.eventos, p.saidas,
+               p.telemetria, p.flash);
+        if (rastro && p.telemetria > 0)
+            fprintf(stderr, "aviso: %u quadro(s) de telemetria perdidos; o rastro pode estar incompleto\n",
+                    p.telemetria);
+        return;
+    }
+    case TEL_RESTAURADO:
+    {
+        tel_restaurado_t r;
+        if (n != sizeof(r))
+            break;
+        memcpy(&r, conteudo, n);
+        printf("[%10u] restaurado zona=%u usuarios=%u\n", r.timestamp_us, r.zona, r.usuarios);
+        return;
+    }
+    }
+    printf("tipo %u desconhecido (%u bytes)\n", tipo, n);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 3 && strcmp(argv[1], "-r") == 0)
+    {
+        rastro = fopen(argv[2], "w");
+        if (!rastro)
+        {
+            perror(argv[2]);
+            return 1;
+        }
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "uso: %s [-r rastro.txt]\n", argv[0]);
+        return 2;
+    }
+
+    // Janela de bytes ainda não consumidos; o quadro mais longo cabe nela
+    uint8_t buf[TEL_CONTEUDO_MAX + 4];
+    uint32_t n = 0;
+    uint32_t quadros = 0, invalidos = 0;
+    bool fim = false;
+
+    while (!fim || n > 0)
+    {
+        if (!fim && n < sizeof(buf))
+        {
+            int c = getchar();
+            if (c == EOF)
+                fim = true;
+            else
+                buf[n++] = (uint8_t)c;
+            if (!fim && n < 4)
+                continue;
+        }
+        if (n == 0)
+            continue; // fim da entrada logo após um quadro
+
+        if (buf[0] != TEL_SINC)
+        {
+            putchar(buf[0]);
+            memmove(buf, buf + 1, --n);
+            continue;
+        }
+
+        uint8_t tamanho = n > 1 ? buf[1] : 0;
+        if (n > 1 && tamanho <= TEL_CONTEUDO_MAX && n < tamanho + 4u && !fim)
+            continue; // quadro ainda incompleto
+
+        bool valido = n > 1 && tamanho <= TEL_CONTEUDO_MAX && n >= tamanho + 4u;
+        if (valido)
+        {
+            uint8_t x = 0;
+            for (uint8_t i = 1; i < tamanho + 3; ++i)
+                x ^= buf[i];
+            valido = x == buf[tamanho + 3];
+        }
+
+        if (!valido)
+        {
+            invalidos++;
+            putchar(buf[0]);
+            memmove(buf, buf + 1, --n);
+            continue;
+        }
+
+        imprimir(buf[2], &buf[3], tamanho);
+        quadros++;
+        n -= tamanho + 4;
+        memmove(buf, buf + tamanho + 4, n);
+        fflush(stdout);
+    }
+
+    fprintf(stderr, "%u quadro(s), %u invalido(s)\n", quadros, invalidos);
+    if (rastro)
+    {
+        fclose(rastro);
+        fprintf(stderr, "%u evento(s) no rastro\n", rastro_eventos);
+    }
+    return 0;
+}
@@ -42,7 +42,17 @@
  
  /* Scheduler Related */
  #define configUSE_PREEMPTION                    1
+ /* PAINEL_ECONOMIA (opção do CMake): tickless idle, o núcleo dorme em WFI
+  * sem a interrupção de tick enquanto nenhuma tarefa está pronta. A porta
+  * do RP2040 só o suporta com um núcleo; a porta POSIX não o suporta. */
+ #ifndef PAINEL_ECONOMIA
+ #define PAINEL_ECONOMIA                         0
+ #endif
+ #if PAINEL_ECONOMIA && !PAINEL_SMP && !PAINEL_HOST
+ #define configUSE_TICKLESS_IDLE                 1
+ #else
  #define configUSE_TICKLESS_IDLE                 0
+ #endif
  #define configUSE_IDLE_HOOK                     0
  #define configUSE_TICK_HOOK                     0
  #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
@@ -69,20 +79,43 @@
  #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
  
  /* Memory allocation related definitions. */
+ /* PAINEL_STATIC (opção do CMake): tarefas, fila e timer em memória estática;
+  * o heap do FreeRTOS não é ligado ao firmware. */
+ #ifndef PAINEL_STATIC
+ #define PAINEL_STATIC                           0
+ #endif
+ #if PAINEL_STATIC
+ #define configSUPPORT_STATIC_ALLOCATION         1
+ #define configSUPPORT_DYNAMIC_ALLOCATION        0
+ #else
  #define configSUPPORT_STATIC_ALLOCATION         0
  #define configSUPPORT_DYNAMIC_ALLOCATION        1
+ #endif
  #define configTOTAL_HEAP_SIZE                   (128*1024)
  #define configAPPLICATION_ALLOCATED_HEAP        0
  
  /* Hook function related definitions. */
+ /* Na placa, estouro de pilha chama vApplicationStackOverflowHook (Painel_de_Controle.c) */
+ #if PAINEL_HOST
  #define configCHECK_FOR_STACK_OVERFLOW          0
+ #else
+ #define configCHECK_FOR_STACK_OVERFLOW          2
+ #endif
  #define configUSE_MALLOC_FAILED_HOOK            0
  #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
  
  /* Run time and task stats gathering related definitions. */
- #define configGENERATE_RUN_TIME_STATS           0
+ #define configGENERATE_RUN_TIME_STATS           1
  #define configUSE_TRACE_FACILITY                1
  #define configUSE_STATS_FORMATTING_FUNCTIONS    0
+ #define configRUN_TIME_COUNTER_TYPE             uint64_t
+
+ /* Contador em microssegundos (timer do RP2040), definido em Painel_de_Controle.c */
+ #ifndef __ASSEMBLER__
+ extern uint64_t painel_runtime_us(void);
+ #endif
+ #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+ #define portGET_RUN_TIME_COUNTER_VALUE()        painel_runtime_us()
  
  /* Co-routine related definitions. */
  #define configUSE_CO_ROUTINES                   0
@@ -102,8 +135,21 @@
  */
  
  /* SMP port only */
- #define configNUM_CORES                         1
+ /* PAINEL_SMP (opção do CMake) usa os dois núcleos do RP2040 com afinidade
+  * de tarefas: entrada e lógica no núcleo 0, display/LED/buzzer no núcleo 1. */
+ #ifndef PAINEL_SMP
+ #define PAINEL_SMP                              0
+ #endif
+ #if PAINEL_SMP
+ #define configNUMBER_OF_CORES                   2
+ #define configUSE_CORE_AFFINITY                 1
+ #define configTICK_CORE                         0
+ #define configUSE_PASSIVE_IDLE_HOOK             0
+ #else
+ #define configNUMBER_OF_CORES                   1
  #define configTICK_CORE                         1
+ #endif
+ #define configNUM_CORES                         configNUMBER_OF_CORES
  #define configRUN_MULTIPLE_PRIORITIES           1
  
  /* RP2040 specific */
@@ -0,0 +1,113 @@
+#include "botoes.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "botoes.pio.h"
+#if PAINEL_BOTOES_DMA
+#include "hardware/dma.h"
+#endif
+
+#define BOTOES_PIO pio0
+#define BOTOES_IRQ PIO0_IRQ_0
+#define BOTOES_CICLOS_US 4 // ciclos de uma iteração do programa (1 us)
+
+static uint8_t total;
+static uint32_t atraso_us; // da borda até o evento sair da máquina de estados
+static uint32_t base_us;   // time_us_32 no tempo 0 das máquinas de estados
+static botoes_callback_t aviso;
+
+#if PAINEL_BOTOES_DMA
+// A DMA copia a FIFO RX de cada máquina de estados para um anel na RAM, então
+// nada se perde mesmo com as interrupções desligadas por muito tempo
+#define BOTOES_ANEL 8 // eventos por anel (potência de 2)
+static uint32_t aneis[BOTOES_MAX][BOTOES_ANEL] __attribute__((aligned(BOTOES_ANEL * sizeof(uint32_t))));
+static int canais[BOTOES_MAX];
+static uint32_t lidos[BOTOES_MAX];
+
+static void botoes_dma_init(uint sm)
+{
+    canais[sm] = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(canais[sm]);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(sizeof(aneis[sm])));
+    channel_config_set_dreq(&c, pio_get_dreq(BOTOES_PIO, sm, false));
+    dma_channel_configure(canais[sm], &c, aneis[sm], &BOTOES_PIO->rxf[sm], 0xFFFFFFFFu, true);
+}
+
+// Entrega os eventos que a DMA já copiou; se o anel deu a volta, os mais antigos se perderam
+static void botoes_drenar(uint sm)
+{
+    while (!pio_sm_is_rx_fifo_empty(BOTOES_PIO, sm))
+        tight_loop_contents(); // a DMA esvazia a FIFO em poucos ciclos
+
+    uint32_t escritos = ~dma_channel_hw_addr(canais[sm])->transfer_count;
+    if (escritos - lidos[sm] > BOTOES_ANEL)
+        lidos[sm] = escritos - BOTOES_ANEL;
+    while (lidos[sm] != escritos)
+        aviso(sm, base_us + aneis[sm][lidos[sm]++ & (BOTOES_ANEL - 1)] - atraso_us);
+}
+#else
+static void botoes_drenar(uint sm)
+{
+    while (!pio_sm_is_rx_fifo_empty(BOTOES_PIO, sm))
+        aviso(sm, base_us + pio_sm_get(BOTOES_PIO, sm) - atraso_us);
+}
+#endif
+
+// Flag de IRQ da PIO levantada pelo programa a cada pressionamento
+static void botoes_irq(void)
+{
+    for (uint sm = 0; sm < total; ++sm)
+    {
+        if (!pio_interrupt_get(BOTOES_PIO, sm))
+            continue;
+        pio_interrupt_clear(BOTOES_PIO, sm);
+        botoes_drenar(sm);
+    }
+}
+
+// Carrega o programa e inicia uma máquina de estados por pino (até BOTOES_MAX).
+// O pino precisa estar configurado como entrada com pull-up. Um pressionamento
+// é aceito após janela_us com o pino estável em 0.
+void botoes_init(const uint *pinos, uint8_t n, uint32_t janela_us, botoes_callback_t callback)
+{
+    if (n > BOTOES_MAX || janela_us == 0)
+        panic("botoes: %u pinos, janela de %lu us", n, (unsigned long)janela_us);
+
+    uint offset = pio_add_program(BOTOES_PIO, &botao_program);
+
+    // Divisor de clock para uma iteração por microssegundo (parte fracionária em 1/256)
+    uint32_t div_256 = (uint32_t)(((uint64_t)clock_get_hz(clk_sys) * 256) / (BOTOES_CICLOS_US * 1000000u));
+
+    // O programa exige janela + 1 iterações em 0 (Y conta até 0 inclusive) e
+    // publica na iteração seguinte
+    uint32_t janela = janela_us - 1;
+    atraso_us = janela + 2;
+    total = n;
+    aviso = callback;
+
+    uint32_t mascara = 0;
+    for (uint8_t sm = 0; sm < n; ++sm)
+    {
+        pio_sm_claim(BOTOES_PIO, sm);
+        pio_sm_config c = botao_program_get_default_config(offset);
+        sm_config_set_jmp_pin(&c, pinos[sm]);
+        sm_config_set_clkdiv_int_frac(&c, div_256 >> 8, div_256 & 0xFF);
+        pio_sm_init(BOTOES_PIO, sm, offset, &c);
+        pio_sm_put(BOTOES_PIO, sm, janela);
+#if PAINEL_BOTOES_DMA
+        botoes_dma_init(sm);
+#endif
+        pio_set_irq0_source_enabled(BOTOES_PIO, pis_interrupt0 + sm, true);
+        mascara |= 1u << sm;
+    }
+
+    irq_set_exclusive_handler(BOTOES_IRQ, botoes_irq);
+    irq_set_enabled(BOTOES_IRQ, true);
+
+    // Todas as máquinas partem juntas: o tempo de cada uma vale para todas
+    pio_enable_sm_mask_in_sync(BOTOES_PIO, mascara);
+    base_us = time_us_32();
+}
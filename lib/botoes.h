@@ -0,0 +1,17 @@
+#ifndef BOTOES_H
+#define BOTOES_H
+
+#include "pico/stdlib.h"
+
+// Leitura dos botões pela PIO (lib/botoes.pio): uma máquina de estados por
+// botão faz o debounce em hardware e publica só os pressionamentos aceitos,
+// com o instante da borda. A CPU é interrompida uma vez por pressionamento.
+#define BOTOES_MAX 4 // máquinas de estados de uma PIO
+
+// Chamado na interrupção para cada pressionamento (índice do pino e instante
+// da borda no relógio de time_us_32)
+typedef void (*botoes_callback_t)(uint8_t indice, uint32_t instante_us);
+
+void botoes_init(const uint *pinos, uint8_t n, uint32_t janela_us, botoes_callback_t callback);
+
+#endif
@@ -1,8 +1,15 @@
-#ifndef BUZZER_H
-#define BUZZER_H
+#include "buzzer.h"
+#include "hardware/sync.h"
 
-#include "pico/stdlib.h"
-#include "hardware/pwm.h"
+// Estado do sequenciador (compartilhado com o callback do alarme)
+static uint seq_pin;
+static buzzer_nota_t seq_notas[BUZZER_MAX_NOTAS];
+static volatile uint8_t seq_total;
+static volatile uint8_t seq_pos;
+static volatile uint8_t seq_prioridade;
+static volatile bool seq_ativo;
+static alarm_id_t seq_alarme;
+static alarm_pool_t *seq_pool;
 
 // Inicializa o buzzer (configura o pino como PWM)
 void buzzer_init(uint BUZZER_PIN)
@@ -10,16 +17,22 @@ void buzzer_init(uint BUZZER_PIN)
     gpio_set_function(BUZZER_PIN, GPIO_FUNC_PWM);
 }
 
-// Emite um som no buzzer com a frequência e duração desejadas
-void buzzer_play(uint BUZZER_PIN, uint freq, uint duration_ms)
+// Liga o PWM na frequência desejada (freq 0 desliga)
+static void buzzer_tom(uint BUZZER_PIN, uint freq)
 {
-    // Obtém o número do slice PWM correspondente ao pino
     uint slice_num = pwm_gpio_to_slice_num(BUZZER_PIN);
 
-    // Calcula o valor do contador TOP para alcançar a frequência desejada
-    uint top = 125000000 / freq;
+    if (freq == 0)
+    {
+        pwm_set_enabled(slice_num, false);
+        return;
+    }
+
+    // Calcula o valor do contador TOP; o divisor mantém TOP dentro de 16 bits
+    uint div = 125000000 / (freq * 65536u) + 1;
+    uint top = 125000000 / (div * freq);
 
-    // Define o valor máximo do contador PWM (wrap)
+    pwm_set_clkdiv_int_frac(slice_num, div, 0);
     pwm_set_wrap(slice_num, top);
 
     // Define o duty cycle
@@ -27,15 +40,101 @@ void buzzer_play(uint BUZZER_PIN, uint freq, uint duration_ms)
 
     // Ativa o PWM
     pwm_set_enabled(slice_num, true);
+}
+
+// Emite um som no buzzer com a frequência e duração desejadas (bloqueante)
+void buzzer_play(uint BUZZER_PIN, uint freq, uint duration_ms)
+{
+    buzzer_tom(BUZZER_PIN, freq);
 
     // Toca o som pelo tempo especificado
     sleep_ms(duration_ms);
 
     // Desativa o PWM
-    pwm_set_enabled(slice_num, false);
+    buzzer_tom(BUZZER_PIN, 0);
 
     // Pausa entre os tons
     sleep_ms(20);
 }
 
-#endif
+// Encerra a melodia com o buzzer desligado
+static void buzzer_seq_parar(void)
+{
+    buzzer_tom(seq_pin, 0);
+    seq_ativo = false;
+}
+
+// Callback do alarme de hardware: avança para a próxima nota da melodia.
+// O retorno reagenda o alarme a partir do instante previsto, sem acumular atraso.
+static int64_t buzzer_seq_alarme(alarm_id_t id, void *user_data)
+{
+    if (++seq_pos >= seq_total)
+    {
+        buzzer_seq_parar();
+        return 0;
+    }
+    buzzer_tom(seq_pin, seq_notas[seq_pos].freq);
+    return (int64_t)seq_notas[seq_pos].duration_ms * 1000;
+}
+
+// Inicializa o sequenciador de melodias no pino do buzzer. O sequenciador usa
+// um alarme de hardware próprio cuja IRQ atende o núcleo que chamou esta função;
+// buzzer_seq_play deve ser chamada a partir desse mesmo núcleo.
+void buzzer_seq_init(uint BUZZER_PIN)
+{
+    seq_pin = BUZZER_PIN;
+    seq_ativo = false;
+    buzzer_init(BUZZER_PIN);
+    seq_pool = alarm_pool_create_with_unused_hardware_alarm(2);
+}
+
+// Inicia uma melodia e retorna imediatamente; as notas são trocadas pelo alarme.
+// Uma melodia em andamento só é interrompida por outra de prioridade maior ou igual.
+// Notas de duração 0 são ignoradas: o retorno 0 do callback encerraria o
+// alarme com o tom ligado. Retorna false se a melodia foi descartada.
+bool buzzer_seq_play(const buzzer_nota_t *melodia, uint8_t n, uint8_t prioridade)
+{
+    if (n > BUZZER_MAX_NOTAS)
+        n = BUZZER_MAX_NOTAS;
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < n; ++i)
+        if (melodia[i].duration_ms > 0)
+            total++;
+    if (total == 0)
+        return false;
+
+    uint32_t irq = save_and_disable_interrupts();
+    if (seq_ativo)
+    {
+        if (prioridade < seq_prioridade)
+        {
+            restore_interrupts(irq);
+            return false;
+        }
+        alarm_pool_cancel_alarm(seq_pool, seq_alarme);
+    }
+
+    for (uint8_t i = 0, j = 0; i < n; ++i)
+        if (melodia[i].duration_ms > 0)
+            seq_notas[j++] = melodia[i];
+    seq_total = total;
+    seq_pos = 0;
+    seq_prioridade = prioridade;
+    seq_ativo = true;
+    buzzer_tom(seq_pin, seq_notas[0].freq);
+
+    seq_alarme = alarm_pool_add_alarm_in_ms(seq_pool, seq_notas[0].duration_ms, buzzer_seq_alarme, NULL, true);
+    if (seq_alarme < 0)
+    {
+        // Sem alarme livre: não deixa o buzzer ligado indefinidamente
+        buzzer_seq_parar();
+    }
+    restore_interrupts(irq);
+    return seq_ativo;
+}
+
+// true enquanto uma melodia estiver tocando
+bool buzzer_seq_tocando(void)
+{
+    return seq_ativo;
+}
@@ -4,7 +4,24 @@
 #include "pico/stdlib.h"
 #include "hardware/pwm.h"
 
+#define BUZZER_MAX_NOTAS 8 // notas por melodia no sequenciador
+
+// Prioridades do sequenciador: uma melodia só interrompe outra de prioridade menor ou igual
+#define BUZZER_PRIO_AVISO 0
+#define BUZZER_PRIO_ALARME 1
+
+// Nota de uma melodia (freq 0 = pausa)
+typedef struct
+{
+    uint16_t freq;
+    uint16_t duration_ms;
+} buzzer_nota_t;
+
 void buzzer_init(uint BUZZER_PIN);
 void buzzer_play(uint BUZZER_PIN, uint freq, uint duration_ms);
 
+void buzzer_seq_init(uint BUZZER_PIN);
+bool buzzer_seq_play(const buzzer_nota_t *melodia, uint8_t n, uint8_t prioridade);
+bool buzzer_seq_tocando(void);
+
 #endif
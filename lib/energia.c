@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include "energia.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Tempo acumulado do display em cada estado e início do estado atual
+static uint64_t tempo_us[ENERGIA_NIVEIS];
+static uint64_t desde_us;
+static volatile energia_display_t nivel_atual = ENERGIA_PLENO;
+
+static const char *const nomes_nivel[ENERGIA_NIVEIS] = {"pleno", "esmaecido", "desligado"};
+static const uint32_t consumo_ua[ENERGIA_NIVEIS] = {
+    [ENERGIA_PLENO] = ENERGIA_DISPLAY_PLENO_UA,
+    [ENERGIA_ESMAECIDO] = ENERGIA_DISPLAY_ESMAECIDO_UA,
+    [ENERGIA_DESLIGADO] = ENERGIA_DISPLAY_DESLIGADO_UA,
+};
+
+// Energia (mJ a 3,3 V) de uma corrente mantida por um intervalo
+static uint32_t energia_mj(uint32_t ua, uint64_t us)
+{
+    return (uint32_t)(ua * us * 33 / 10000000000ull);
+}
+
+// Chamada pela tarefa do display a cada troca de estado
+void energia_display(energia_display_t nivel)
+{
+    uint64_t agora = time_us_64();
+    taskENTER_CRITICAL();
+    tempo_us[nivel_atual] += agora - desde_us;
+    desde_us = agora;
+    nivel_atual = nivel;
+    taskEXIT_CRITICAL();
+}
+
+energia_display_t energia_display_nivel(void)
+{
+    return nivel_atual;
+}
+
+// Fração ociosa da CPU desde o boot, tempo do display em cada estado e a
+// economia estimada em relação ao display sempre pleno e ao tick contínuo
+void energia_relatorio(void)
+{
+    uint64_t tempos[ENERGIA_NIVEIS];
+    uint64_t agora = time_us_64();
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < ENERGIA_NIVEIS; ++i)
+        tempos[i] = tempo_us[i];
+    tempos[nivel_atual] += agora - desde_us;
+    taskEXIT_CRITICAL();
+
+    uint64_t total = portGET_RUN_TIME_COUNTER_VALUE() * configNUMBER_OF_CORES;
+    uint64_t ocioso = ulTaskGetIdleRunTimeCounter();
+    unsigned permil = total ? (unsigned)(ocioso * 1000 / total) : 0;
+    printf("CPU ociosa: %u.%u%% (%u nucleo(s), tickless %s)\n", permil / 10, permil % 10,
+           configNUMBER_OF_CORES, configUSE_TICKLESS_IDLE ? "ativo" : "inativo");
+
+    uint32_t economia_display = 0;
+    for (uint8_t i = 0; i < ENERGIA_NIVEIS; ++i)
+    {
+        printf("display %-10s %10llu ms\n", nomes_nivel[i], (unsigned long long)(tempos[i] / 1000));
+        economia_display += energia_mj(ENERGIA_DISPLAY_PLENO_UA - consumo_ua[i], tempos[i]);
+    }
+
+    // Sem tickless a idle executa continuamente, então não há economia na CPU
+    uint32_t economia_cpu = configUSE_TICKLESS_IDLE
+                                ? energia_mj(ENERGIA_NUCLEO_ATIVO_UA - ENERGIA_NUCLEO_WFI_UA, ocioso)
+                                : 0;
+    printf("economia estimada: display %lu mJ, CPU %lu mJ\n", (unsigned long)economia_display,
+           (unsigned long)economia_cpu);
+}
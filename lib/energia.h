@@ -0,0 +1,28 @@
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include "pico/stdlib.h"
+
+// Estado de energia do display, escolhido pelo tempo sem eventos
+typedef enum
+{
+    ENERGIA_PLENO,      // contraste máximo
+    ENERGIA_ESMAECIDO,  // contraste reduzido
+    ENERGIA_DESLIGADO,  // painel em modo sleep (SET_DISP)
+    ENERGIA_NIVEIS
+} energia_display_t;
+
+// Consumo estimado em uA (3,3 V), usado só para estimar a economia.
+// Display: 128x64 com as telas do painel (cerca de 15% dos pixels acesos).
+#define ENERGIA_DISPLAY_PLENO_UA 6000
+#define ENERGIA_DISPLAY_ESMAECIDO_UA 1500
+#define ENERGIA_DISPLAY_DESLIGADO_UA 10
+// Um núcleo do RP2040 a 125 MHz executando o laço da idle e parado em WFI
+#define ENERGIA_NUCLEO_ATIVO_UA 9000
+#define ENERGIA_NUCLEO_WFI_UA 4000
+
+void energia_display(energia_display_t nivel);
+energia_display_t energia_display_nivel(void);
+void energia_relatorio(void);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+#include "pico/stdlib.h"
+#include "fila_spsc.h"
+
+// Capacidade da fila de eventos (potência de 2)
+#define EVENTOS_CAPACIDADE 64
+
+// Tipos de evento gerados pelos botões
+typedef enum
+{
+    EVENTO_ENTRADA,
+    EVENTO_SAIDA,
+    EVENTO_RESET
+} evento_tipo_t;
+
+// Evento com o instante (us desde o boot) da borda que o gerou
+typedef struct
+{
+    uint32_t timestamp_us;
+    uint8_t tipo;
+    uint8_t porta; // porta de entrada/saída (ignorada no reset)
+} evento_t;
+
+// Fila dos eventos: produzida pela ISR dos botões, consumida pela tarefa de eventos
+FILA_SPSC(eventos, evento_t, EVENTOS_CAPACIDADE)
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef FILA_SPSC_H
+#define FILA_SPSC_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+// Fila circular sem trava para um produtor e um consumidor (uma ISR e uma
+// tarefa, ou duas tarefas em núcleos diferentes). head só é escrito pelo
+// produtor e tail só pelo consumidor.
+//
+// FILA_SPSC(nome, tipo, capacidade) define o tipo nome_fila_t e as funções:
+// - nome_push: insere um item (lado do produtor). Retorna false e conta a
+//   perda em perdidos se a fila estiver cheia.
+// - nome_pop: remove o item mais antigo (lado do consumidor). Retorna false
+//   se a fila estiver vazia.
+// - nome_pendentes: quantidade de itens aguardando consumo.
+// A capacidade deve ser potência de 2.
+#define FILA_SPSC(nome, tipo, capacidade)                                    \
+    typedef struct                                                           \
+    {                                                                        \
+        tipo itens[capacidade];                                              \
+        volatile uint32_t head;                                              \
+        volatile uint32_t tail;                                              \
+        volatile uint32_t perdidos; /* itens descartados com a fila cheia */ \
+    } nome##_fila_t;                                                         \
+                                                                             \
+    static inline bool nome##_push(nome##_fila_t *fila, const tipo *item)    \
+    {                                                                        \
+        uint32_t head = fila->head;                                          \
+        if (head - fila->tail >= (capacidade))                               \
+        {                                                                    \
+            fila->perdidos++;                                                \
+            return false;                                                    \
+        }                                                                    \
+        fila->itens[head & ((capacidade) - 1)] = *item;                      \
+        __dmb(); /* o item fica visível antes do novo head */                \
+        fila->head = head + 1;                                               \
+        return true;                                                         \
+    }                                                                        \
+                                                                             \
+    static inline bool nome##_pop(nome##_fila_t *fila, tipo *item)           \
+    {                                                                        \
+        uint32_t tail = fila->tail;                                          \
+        if (tail == fila->head)                                              \
+            return false;                                                    \
+        __dmb();                                                             \
+        *item = fila->itens[tail & ((capacidade) - 1)];                      \
+        __dmb(); /* a leitura termina antes de liberar a posição */          \
+        fila->tail = tail + 1;                                               \
+        return true;                                                         \
+    }                                                                        \
+                                                                             \
+    static inline uint32_t nome##_pendentes(const nome##_fila_t *fila)       \
+    {                                                                        \
+        return fila->head - fila->tail;                                      \
+    }
+
+#endif
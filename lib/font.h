@@ -1,4 +1,10 @@
-static uint8_t font[] = {
+// Fonte 8x8 do código ' ' ao '~': 8 bytes por caractere, um por coluna (bit 0 em cima).
+// Em C++ é constexpr para que as telas possam ser renderizadas na compilação.
+#ifdef __cplusplus
+static constexpr uint8_t font[] = {
+#else
+static const uint8_t font[] = {
+#endif
 
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //  
 0x00, 0x00, 0x00, 0x5F, 0x5F, 0x00, 0x00, 0x00, // !
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include "latencia.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+static latencia_hist_t histogramas[EVENTO_TIPOS][LAT_ETAPAS];
+
+// Origem (ISR) do evento mais antigo de cada tipo que ainda não chegou à tela
+static uint32_t pendente_us[EVENTO_TIPOS];
+static uint8_t pendente_mascara;
+
+static const char *const nomes_tipo[EVENTO_TIPOS] = {"entrada", "saida", "reset"};
+static const char *const nomes_etapa[LAT_ETAPAS] = {"isr->tarefa", "isr->display", "isr->tela"};
+
+// Faixa do histograma: valores 0..3 exatos, depois 4 faixas por potência de 2
+static inline uint8_t latencia_faixa(uint32_t us)
+{
+    if (us < 4)
+        return us;
+    uint8_t msb = 31 - __builtin_clz(us);
+    uint32_t faixa = (msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+    return faixa < LATENCIA_FAIXAS ? faixa : LATENCIA_FAIXAS - 1;
+}
+
+// Maior valor (us) que cai na faixa
+static uint32_t latencia_limite(uint8_t faixa)
+{
+    if (faixa < 4)
+        return faixa;
+    uint8_t msb = faixa / 4 + 1;
+    uint32_t inicio = (4u + (faixa & 3)) << (msb - 2);
+    return inicio + (1u << (msb - 2)) - 1;
+}
+
+// O(1) e sem trava: chamada pela tarefa dona da etapa
+void latencia_registrar(uint8_t tipo, latencia_etapa_t etapa, uint32_t us)
+{
+    latencia_hist_t *hist = &histogramas[tipo][etapa];
+    hist->contagem[latencia_faixa(us)]++;
+    hist->total++;
+    if (us > hist->max_us)
+        hist->max_us = us;
+}
+
+// Marca um evento à espera da tela (mantém o mais antigo de cada tipo).
+// A tarefa de eventos e a do display podem estar em núcleos diferentes.
+void latencia_pendente(uint8_t tipo, uint32_t origem_us)
+{
+    taskENTER_CRITICAL();
+    if (!(pendente_mascara & (1u << tipo)))
+    {
+        pendente_us[tipo] = origem_us;
+        pendente_mascara |= 1u << tipo;
+    }
+    taskEXIT_CRITICAL();
+}
+
+// Retira os eventos pendentes; retorna a máscara dos tipos presentes
+uint8_t latencia_coletar(uint32_t origem_us[EVENTO_TIPOS])
+{
+    taskENTER_CRITICAL();
+    uint8_t mascara = pendente_mascara;
+    memcpy(origem_us, pendente_us, sizeof(pendente_us));
+    pendente_mascara = 0;
+    taskEXIT_CRITICAL();
+    return mascara;
+}
+
+// Limite superior (us) da faixa que contém o percentil pedido
+uint32_t latencia_percentil(const latencia_hist_t *hist, uint8_t percentil)
+{
+    if (hist->total == 0)
+        return 0;
+    uint32_t alvo = ((uint64_t)hist->total * percentil + 99) / 100;
+    uint32_t acumulado = 0;
+    for (uint8_t f = 0; f < LATENCIA_FAIXAS; ++f)
+    {
+        acumulado += hist->contagem[f];
+        if (acumulado >= alvo)
+            return latencia_limite(f) < hist->max_us ? latencia_limite(f) : hist->max_us;
+    }
+    return hist->max_us;
+}
+
+// Imprime p50/p99/máx de cada tipo e etapa (fora do caminho crítico)
+void latencia_relatorio(void)
+{
+    printf("latencia (us)      etapa          n        p50        p99        max\n");
+    for (uint8_t t = 0; t < EVENTO_TIPOS; ++t)
+    {
+        for (uint8_t e = 0; e < LAT_ETAPAS; ++e)
+        {
+            const latencia_hist_t *hist = &histogramas[t][e];
+            printf("%-18s %-12s %6lu %10lu %10lu %10lu\n", nomes_tipo[t], nomes_etapa[e],
+                   (unsigned long)hist->total,
+                   (unsigned long)latencia_percentil(hist, 50),
+                   (unsigned long)latencia_percentil(hist, 99),
+                   (unsigned long)hist->max_us);
+        }
+    }
+}
+
+void latencia_zerar(void)
+{
+    memset(histogramas, 0, sizeof(histogramas));
+}
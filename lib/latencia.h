@@ -0,0 +1,34 @@
+#ifndef LATENCIA_H
+#define LATENCIA_H
+
+#include "eventos.h"
+
+#define EVENTO_TIPOS 3 // entrada, saída e reset
+
+// Etapas medidas a partir da borda do botão (entrada da ISR)
+typedef enum
+{
+    LAT_FILA,    // ISR -> tarefa de eventos retira o evento da fila
+    LAT_DISPLAY, // ISR -> tarefa do display assume a tela
+    LAT_TELA,    // ISR -> fim do envio do quadro ao display
+    LAT_ETAPAS
+} latencia_etapa_t;
+
+// Histograma log-linear: 4 faixas por potência de 2 (erro < 25%) até ~2^27 us
+#define LATENCIA_FAIXAS 104
+
+typedef struct
+{
+    uint32_t contagem[LATENCIA_FAIXAS];
+    uint32_t total;
+    uint32_t max_us;
+} latencia_hist_t;
+
+void latencia_registrar(uint8_t tipo, latencia_etapa_t etapa, uint32_t us);
+void latencia_pendente(uint8_t tipo, uint32_t origem_us);
+uint8_t latencia_coletar(uint32_t origem_us[EVENTO_TIPOS]);
+uint32_t latencia_percentil(const latencia_hist_t *hist, uint8_t percentil);
+void latencia_relatorio(void);
+void latencia_zerar(void);
+
+#endif
@@ -0,0 +1,174 @@
+#include "led.h"
+#if PAINEL_LED_PWM
+#include "hardware/pwm.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#endif
+
+static uint pinos[3]; // r, g, b
+static uint32_t mascara;
+static uint8_t brilho_global = 255;
+static led_estado_t atual;
+
+#if PAINEL_LED_PWM
+// Nível do PWM: 0-255 ao quadrado (correção aproximada de gama)
+#define LED_TOPO (255u * 255u)
+
+// Um canal de DMA e uma tabela em anel por slice usado pelo LED. Cada palavra
+// é o registrador CC do slice: os níveis dos canais A e B de uma só vez.
+static uint8_t total_slices;
+static uint slices[3];
+static int canais[3];
+static uint32_t tabelas[3][LED_PASSOS] __attribute__((aligned(LED_PASSOS * sizeof(uint32_t))));
+
+// Envoltória do efeito no passo k (0-255)
+static uint8_t led_envoltoria(led_efeito_t efeito, uint k)
+{
+    switch (efeito)
+    {
+    case LED_PISCAR:
+        return k < LED_PASSOS / 2 ? 255 : 0;
+    case LED_RESPIRAR:
+        return k < LED_PASSOS / 2 ? k * 255 / (LED_PASSOS / 2) : (LED_PASSOS - k) * 255 / (LED_PASSOS / 2);
+    default:
+        return 255;
+    }
+}
+
+static uint32_t led_nivel(uint8_t canal, uint8_t envoltoria)
+{
+    uint32_t v = (uint32_t)canal * brilho_global / 255 * envoltoria / 255;
+    return v * v;
+}
+
+// Palavra CC do slice s para uma cor e uma envoltória
+static uint32_t led_cc(uint s, const led_cor_t *cor, uint8_t envoltoria)
+{
+    const uint8_t canal[3] = {cor->r, cor->g, cor->b};
+    uint32_t cc = 0;
+    for (uint8_t i = 0; i < 3; ++i)
+        if (pwm_gpio_to_slice_num(pinos[i]) == slices[s])
+            cc |= led_nivel(canal[i], envoltoria) << (16 * pwm_gpio_to_channel(pinos[i]));
+    return cc;
+}
+
+static void led_pwm_init(void)
+{
+    pwm_config c = pwm_get_default_config();
+    pwm_config_set_wrap(&c, LED_TOPO - 1);
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        uint s = pwm_gpio_to_slice_num(pinos[i]);
+        if (s == LED_SLICE_RITMO)
+            panic("led: pino %u no slice de ritmo %u", pinos[i], s);
+        gpio_set_function(pinos[i], GPIO_FUNC_PWM);
+
+        uint8_t j = 0;
+        while (j < total_slices && slices[j] != s)
+            ++j;
+        if (j < total_slices)
+            continue;
+        slices[total_slices++] = s;
+        pwm_init(s, &c, false);
+        pwm_set_counter(s, 0);
+    }
+
+    // Todos os slices do LED contam juntos; o de ritmo só é ligado com um efeito
+    uint32_t ligados = 0;
+    for (uint8_t s = 0; s < total_slices; ++s)
+    {
+        ligados |= 1u << slices[s];
+        canais[s] = dma_claim_unused_channel(true);
+    }
+    pwm_set_mask_enabled(ligados);
+}
+
+static void led_pwm_aplicar(const led_estado_t *estado)
+{
+    // Para o efeito anterior antes de reescrever as tabelas
+    pwm_set_enabled(LED_SLICE_RITMO, false);
+    for (uint8_t s = 0; s < total_slices; ++s)
+        dma_channel_abort(canais[s]);
+
+    if (estado->efeito == LED_FIXO || estado->periodo_ms == 0)
+    {
+        for (uint8_t s = 0; s < total_slices; ++s)
+            pwm_hw->slice[slices[s]].cc = led_cc(s, &estado->cor, 255);
+        return;
+    }
+
+    for (uint8_t s = 0; s < total_slices; ++s)
+        for (uint k = 0; k < LED_PASSOS; ++k)
+            tabelas[s][k] = led_cc(s, &estado->cor, led_envoltoria(estado->efeito, k));
+
+    // Slice de ritmo: um wrap (e um pedido de DMA) por passo. O divisor mantém
+    // o wrap em 16 bits.
+    uint64_t ciclos = (uint64_t)clock_get_hz(clk_sys) * estado->periodo_ms / (1000u * LED_PASSOS);
+    uint32_t div = (uint32_t)(ciclos / 65536u) + 1;
+    if (div > 255)
+        div = 255;
+    uint32_t wrap = (uint32_t)(ciclos / div);
+    if (wrap > 65536u)
+        wrap = 65536u;
+    if (wrap == 0)
+        wrap = 1;
+    pwm_set_clkdiv_int_frac(LED_SLICE_RITMO, div, 0);
+    pwm_set_wrap(LED_SLICE_RITMO, wrap - 1);
+    pwm_set_counter(LED_SLICE_RITMO, 0);
+
+    // A leitura dá a volta na tabela (anel) e a contagem máxima dura anos:
+    // o efeito não precisa mais da CPU
+    uint32_t mascara_canais = 0;
+    for (uint8_t s = 0; s < total_slices; ++s)
+    {
+        dma_channel_config c = dma_channel_get_default_config(canais[s]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_ring(&c, false, __builtin_ctz(sizeof(tabelas[s])));
+        channel_config_set_dreq(&c, pwm_get_dreq(LED_SLICE_RITMO));
+        dma_channel_configure(canais[s], &c, &pwm_hw->slice[slices[s]].cc, tabelas[s], 0xFFFFFFFFu, false);
+        mascara_canais |= 1u << canais[s];
+    }
+    dma_start_channel_mask(mascara_canais);
+    pwm_set_enabled(LED_SLICE_RITMO, true);
+}
+#endif
+
+// Configura os pinos do LED, apagado
+void led_init(uint pino_r, uint pino_g, uint pino_b)
+{
+    pinos[0] = pino_r;
+    pinos[1] = pino_g;
+    pinos[2] = pino_b;
+    mascara = (1u << pino_r) | (1u << pino_g) | (1u << pino_b);
+
+#if PAINEL_LED_PWM
+    led_pwm_init();
+#else
+    gpio_init_mask(mascara);
+    gpio_set_dir_out_masked(mascara);
+    gpio_put_masked(mascara, 0);
+#endif
+}
+
+// Brilho de todas as cores (0-255, só no modo PWM); vale para o estado atual
+void led_brilho(uint8_t brilho)
+{
+    brilho_global = brilho;
+#if PAINEL_LED_PWM
+    led_pwm_aplicar(&atual);
+#endif
+}
+
+void led_aplicar(const led_estado_t *estado)
+{
+    atual = *estado;
+#if PAINEL_LED_PWM
+    led_pwm_aplicar(estado);
+#else
+    uint32_t valor = (estado->cor.r ? 1u << pinos[0] : 0) | (estado->cor.g ? 1u << pinos[1] : 0) |
+                     (estado->cor.b ? 1u << pinos[2] : 0);
+    gpio_put_masked(mascara, valor);
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef LED_H
+#define LED_H
+
+#include "pico/stdlib.h"
+
+// LED RGB de status. No modo GPIO cada estado é uma única escrita
+// (gpio_put_masked) e um canal acende se a cor dele for diferente de 0. Com
+// PAINEL_LED_PWM as cores são misturadas pelo PWM e os efeitos rodam no
+// hardware: a DMA, ritmada por um slice de PWM livre, copia uma tabela de
+// níveis em anel para os slices do LED, sem a CPU depois de configurado.
+
+#define LED_PASSOS 64 // níveis por período de um efeito (potência de 2)
+
+// Slice usado só como relógio dos efeitos. O 7 é o dos GPIOs 14 e 15, que
+// estão na função I2C, então o contador dele não aciona nenhum pino.
+#ifndef LED_SLICE_RITMO
+#define LED_SLICE_RITMO 7
+#endif
+
+// Cor (0-255 por canal)
+typedef struct
+{
+    uint8_t r, g, b;
+} led_cor_t;
+
+typedef enum
+{
+    LED_FIXO,
+    LED_PISCAR,   // metade do período acesa, metade apagada
+    LED_RESPIRAR, // o brilho sobe e desce ao longo do período
+} led_efeito_t;
+
+typedef struct
+{
+    led_cor_t cor;
+    led_efeito_t efeito; // só no modo PWM; no modo GPIO a cor fica fixa
+    uint16_t periodo_ms; // período do efeito (até ~8 s)
+} led_estado_t;
+
+void led_init(uint pino_r, uint pino_g, uint pino_b);
+void led_brilho(uint8_t brilho);
+void led_aplicar(const led_estado_t *estado);
+
+#endif
@@ -0,0 +1,172 @@
+#include <string.h>
+#include "ocupacao.h"
+
+// Zera as contagens e pré-calcula, para cada porta, as zonas que ela altera.
+// Cada zona deve vir depois do seu pai na tabela. Retorna false se a
+// configuração for inválida.
+bool ocupacao_init(ocupacao_t *oc, const ocupacao_zona_cfg_t *zonas, uint8_t n_zonas,
+                   const ocupacao_porta_cfg_t *portas, uint8_t n_portas)
+{
+    if (n_zonas == 0 || n_zonas > OCUPACAO_MAX_ZONAS || n_portas > OCUPACAO_MAX_PORTAS)
+        return false;
+
+    for (uint8_t z = 0; z < n_zonas; ++z)
+        if (zonas[z].max == 0 || (zonas[z].pai != OCUPACAO_FORA && zonas[z].pai >= z))
+            return false;
+
+    oc->zonas = zonas;
+    oc->n_zonas = n_zonas;
+    oc->n_portas = n_portas;
+    memset(oc->usuarios, 0, sizeof(oc->usuarios));
+
+    // Caminho da zona da porta até a origem (exclusive)
+    for (uint8_t p = 0; p < n_portas; ++p)
+    {
+        uint8_t zona = portas[p].zona;
+        uint8_t passos = 0;
+        if (zona >= n_zonas)
+            return false;
+        while (zona != portas[p].origem)
+        {
+            if (zona == OCUPACAO_FORA || passos == OCUPACAO_PROFUNDIDADE)
+                return false; // origem não é ancestral da zona
+            oc->caminho[p][passos++] = zona;
+            zona = zonas[zona].pai;
+        }
+        if (passos == 0)
+            return false;
+        oc->passos[p] = passos;
+    }
+    return true;
+}
+
+// Nível de ocupação da zona para a contagem atual
+ocupacao_nivel_t ocupacao_nivel(const ocupacao_t *oc, uint8_t zona)
+{
+    const ocupacao_zona_cfg_t *cfg = &oc->zonas[zona];
+    uint16_t usuarios = oc->usuarios[zona];
+
+    if (usuarios == 0)
+        return OCUPACAO_VAZIO;
+    if (usuarios >= cfg->max)
+        return OCUPACAO_LOTADO;
+    if (cfg->max - usuarios <= cfg->aviso)
+        return OCUPACAO_QUASE_CHEIO;
+    return OCUPACAO_LIVRE;
+}
+
+// Ordena o lote pelo instante da borda. A fila já chega quase ordenada,
+// então a inserção direta é praticamente linear. A comparação pela diferença
+// com sinal tolera a volta do contador de microssegundos.
+static void ocupacao_ordenar(evento_t *eventos, uint8_t n)
+{
+    for (uint8_t i = 1; i < n; ++i)
+    {
+        evento_t e = eventos[i];
+        uint8_t j = i;
+        while (j > 0 && (int32_t)(eventos[j - 1].timestamp_us - e.timestamp_us) > 0)
+        {
+            eventos[j] = eventos[j - 1];
+            --j;
+        }
+        eventos[j] = e;
+    }
+}
+
+// Entrada pela porta: recusada se alguma zona do caminho estiver cheia.
+// Retorna a zona a exibir (a da porta ou a que estava cheia).
+static uint8_t ocupacao_entrar(ocupacao_t *oc, uint8_t porta, ocupacao_saida_t *saida)
+{
+    const uint8_t *caminho = oc->caminho[porta];
+    uint8_t passos = oc->passos[porta];
+
+    for (uint8_t k = 0; k < passos; ++k)
+    {
+        if (oc->usuarios[caminho[k]] >= oc->zonas[caminho[k]].max)
+        {
+            saida->ultimo = OCUPACAO_RES_LOTADO;
+            saida->alarme_lotado = true;
+            return caminho[k];
+        }
+    }
+
+    for (uint8_t k = 0; k < passos; ++k)
+        if (++oc->usuarios[caminho[k]] == oc->zonas[caminho[k]].max)
+            saida->alarme_lotado = true;
+    saida->ultimo = OCUPACAO_RES_ENTRADA;
+    return caminho[0];
+}
+
+// Saída pela porta: recusada se alguma zona do caminho estiver vazia.
+// Retorna a zona a exibir (a da porta ou a que estava vazia).
+static uint8_t ocupacao_sair(ocupacao_t *oc, uint8_t porta, ocupacao_saida_t *saida)
+{
+    const uint8_t *caminho = oc->caminho[porta];
+    uint8_t passos = oc->passos[porta];
+
+    for (uint8_t k = 0; k < passos; ++k)
+    {
+        if (oc->usuarios[caminho[k]] == 0)
+        {
+            saida->ultimo = OCUPACAO_RES_VAZIO;
+            return caminho[k];
+        }
+    }
+    for (uint8_t k = 0; k < passos; ++k)
+        oc->usuarios[caminho[k]]--;
+    saida->ultimo = OCUPACAO_RES_SAIDA;
+    return caminho[0];
+}
+
+// Aplica um lote de eventos em ordem cronológica e resume o resultado
+// em uma única atualização de LED, buzzer e display. Cada evento custa no
+// máximo OCUPACAO_PROFUNDIDADE acessos à tabela de contagens. Retorna o
+// número de eventos aplicados (eventos de portas inexistentes são ignorados).
+uint8_t ocupacao_processar(ocupacao_t *oc, evento_t *eventos, uint8_t n, ocupacao_saida_t *saida)
+{
+    uint8_t zona = 0;
+    uint8_t aplicados = 0;
+
+    saida->alarme_lotado = false;
+    saida->reset = false;
+
+    ocupacao_ordenar(eventos, n);
+
+    for (uint8_t i = 0; i < n; ++i)
+    {
+        uint8_t porta = eventos[i].porta;
+
+        switch (eventos[i].tipo)
+        {
+        case EVENTO_ENTRADA:
+            if (porta >= oc->n_portas)
+                continue;
+            zona = ocupacao_entrar(oc, porta, saida);
+            break;
+
+        case EVENTO_SAIDA:
+            if (porta >= oc->n_portas)
+                continue;
+            zona = ocupacao_sair(oc, porta, saida);
+            break;
+
+        case EVENTO_RESET:
+            memset(oc->usuarios, 0, sizeof(oc->usuarios));
+            zona = 0;
+            saida->ultimo = OCUPACAO_RES_RESET;
+            saida->reset = true;
+            saida->alarme_lotado = false; // o reset encerra o alarme anterior no lote
+            break;
+
+        default:
+            continue;
+        }
+        aplicados++;
+    }
+
+    saida->zona = zona;
+    saida->usuarios = oc->usuarios[zona];
+    saida->nivel = ocupacao_nivel(oc, zona);
+    saida->eventos = aplicados;
+    return aplicados;
+}
@@ -0,0 +1,77 @@
+#ifndef OCUPACAO_H
+#define OCUPACAO_H
+
+#include "eventos.h"
+
+// Nível de ocupação, usado para escolher a cor do LED
+typedef enum
+{
+    OCUPACAO_VAZIO,       // nenhum usuário - azul
+    OCUPACAO_LIVRE,       // várias vagas - verde
+    OCUPACAO_QUASE_CHEIO, // uma vaga restante - amarelo
+    OCUPACAO_LOTADO       // capacidade máxima - vermelho
+} ocupacao_nivel_t;
+
+// Resultado de um evento aplicado à contagem
+typedef enum
+{
+    OCUPACAO_RES_ENTRADA,
+    OCUPACAO_RES_SAIDA,
+    OCUPACAO_RES_LOTADO, // entrada recusada
+    OCUPACAO_RES_VAZIO,  // saída com o local vazio
+    OCUPACAO_RES_RESET
+} ocupacao_resultado_t;
+
+#define OCUPACAO_MAX_ZONAS 16    // zonas por controlador
+#define OCUPACAO_MAX_PORTAS 16   // portas (pares de entrada/saída) por controlador
+#define OCUPACAO_PROFUNDIDADE 4  // níveis de aninhamento atravessados por uma porta
+#define OCUPACAO_FORA 0xFF       // exterior: pai da zona raiz ou origem de uma porta externa
+
+// Configuração de uma zona. Uma zona conta também os usuários das suas
+// subzonas (o andar soma as salas).
+typedef struct
+{
+    const char *nome;
+    uint16_t max;   // capacidade
+    uint16_t aviso; // vagas restantes a partir das quais o nível é "quase cheio"
+    uint8_t pai;    // zona que contém esta (OCUPACAO_FORA para a raiz)
+} ocupacao_zona_cfg_t;
+
+// Configuração de uma porta: liga a zona à origem, que deve ser uma zona
+// ancestral ou o exterior. Passar pela porta altera a zona e os ancestrais
+// dela abaixo da origem.
+typedef struct
+{
+    uint8_t zona;
+    uint8_t origem;
+} ocupacao_porta_cfg_t;
+
+// Contagem de usuários por zona; só a tarefa de eventos deve modificá-la
+typedef struct
+{
+    const ocupacao_zona_cfg_t *zonas;
+    uint8_t n_zonas;
+    uint8_t n_portas;
+    uint16_t usuarios[OCUPACAO_MAX_ZONAS];                        // contagem de cada zona
+    uint8_t caminho[OCUPACAO_MAX_PORTAS][OCUPACAO_PROFUNDIDADE]; // zonas alteradas por cada porta
+    uint8_t passos[OCUPACAO_MAX_PORTAS];                         // tamanho de cada caminho
+} ocupacao_t;
+
+// Atualização consolidada de um lote de eventos
+typedef struct
+{
+    uint8_t zona;                // zona do último evento (a zona cheia, se a entrada foi recusada)
+    uint16_t usuarios;           // contagem dessa zona após o lote
+    ocupacao_nivel_t nivel;      // nível dessa zona após o lote
+    ocupacao_resultado_t ultimo; // resultado do último evento
+    bool alarme_lotado;          // alguma entrada atingiu ou encontrou o limite de uma zona
+    bool reset;                  // houve reset no lote
+    uint8_t eventos;             // eventos aplicados
+} ocupacao_saida_t;
+
+bool ocupacao_init(ocupacao_t *oc, const ocupacao_zona_cfg_t *zonas, uint8_t n_zonas,
+                   const ocupacao_porta_cfg_t *portas, uint8_t n_portas);
+ocupacao_nivel_t ocupacao_nivel(const ocupacao_t *oc, uint8_t zona);
+uint8_t ocupacao_processar(ocupacao_t *oc, evento_t *eventos, uint8_t n, ocupacao_saida_t *saida);
+
+#endif
@@ -0,0 +1,246 @@
+#include <string.h>
+#include "persistencia.h"
+#include "pico/flash.h"
+
+#define PERSIST_MAGIA 0x50434E4Fu // "ONCP"
+#define PERSIST_CHECKPOINT 1
+#define PERSIST_LOG 2
+
+// Lado da tarefa de eventos -> lado da tarefa de gravação
+static eventos_fila_t fila;
+
+// Estado do gravador: contagem correspondente ao que já está na flash
+// (sombra usada nos checkpoints) e próxima posição livre
+static ocupacao_t sombra;
+static uint32_t sequencia;
+static uint8_t setor;
+static uint8_t pagina; // PERSIST_PAGINAS_SETOR força o rodízio para o próximo setor
+static persist_pagina_t log_atual;
+static persist_stats_t stats;
+
+// Operação de flash executada com o XIP desligado
+typedef struct
+{
+    uint32_t offset;
+    const uint8_t *dados; // NULL apaga o setor
+} persist_op_t;
+
+static const persist_pagina_t *persist_ler(uint8_t s, uint8_t p)
+{
+    return (const persist_pagina_t *)(XIP_BASE + PERSIST_OFFSET + s * FLASH_SECTOR_SIZE + p * FLASH_PAGE_SIZE);
+}
+
+static uint32_t persist_crc(const persist_pagina_t *pag)
+{
+    const uint8_t *bytes = (const uint8_t *)pag;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < offsetof(persist_pagina_t, crc); ++i)
+    {
+        crc ^= bytes[i];
+        for (uint8_t b = 0; b < 8; ++b)
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static bool persist_valida(const persist_pagina_t *pag, uint8_t tipo)
+{
+    return pag->magia == PERSIST_MAGIA && pag->tipo == tipo && pag->crc == persist_crc(pag);
+}
+
+static bool persist_apagada(const persist_pagina_t *pag)
+{
+    const uint32_t *palavras = (const uint32_t *)pag;
+    for (size_t i = 0; i < FLASH_PAGE_SIZE / 4; ++i)
+        if (palavras[i] != 0xFFFFFFFFu)
+            return false;
+    return true;
+}
+
+// Roda da RAM: enquanto a flash está ocupada nenhum código pode ser buscado do XIP
+static void __not_in_flash_func(persist_executar)(void *param)
+{
+    const persist_op_t *op = param;
+    if (op->dados == NULL)
+        flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+    else
+        flash_range_program(op->offset, op->dados, FLASH_PAGE_SIZE);
+}
+
+// Executa a operação com o outro núcleo e as interrupções suspensos.
+// Falha (sem tocar na flash) se o outro núcleo não puder ser parado a tempo.
+static bool persist_flash(uint32_t offset, const uint8_t *dados)
+{
+    persist_op_t op = {offset, dados};
+    if (flash_safe_execute(persist_executar, &op, 100) != PICO_OK)
+    {
+        stats.falhas++;
+        return false;
+    }
+    return true;
+}
+
+// Grava o registro na próxima página livre do setor atual
+static bool persist_programar(persist_pagina_t *pag)
+{
+    pag->magia = PERSIST_MAGIA;
+    pag->sequencia = sequencia + 1;
+    pag->crc = persist_crc(pag);
+
+    if (!persist_flash(PERSIST_OFFSET + setor * FLASH_SECTOR_SIZE + pagina * FLASH_PAGE_SIZE, (const uint8_t *)pag))
+        return false;
+    sequencia++;
+    pagina++;
+    stats.paginas++;
+    return true;
+}
+
+// Apaga o próximo setor (o mais antigo) e abre-o com um checkpoint da sombra
+static bool persist_rodar(void)
+{
+    static persist_pagina_t checkpoint;
+    uint8_t proximo = (setor + 1) % PERSIST_SETORES;
+
+    if (!persist_flash(PERSIST_OFFSET + proximo * FLASH_SECTOR_SIZE, NULL))
+        return false;
+    stats.setores++;
+    setor = proximo;
+    pagina = 0;
+
+    memset(&checkpoint, 0, sizeof(checkpoint));
+    checkpoint.tipo = PERSIST_CHECKPOINT;
+    checkpoint.n = sombra.n_zonas;
+    memcpy(checkpoint.usuarios, sombra.usuarios, sizeof(checkpoint.usuarios));
+    if (!persist_programar(&checkpoint))
+    {
+        pagina = PERSIST_PAGINAS_SETOR; // setor sem checkpoint: passa para o seguinte
+        return false;
+    }
+    return true;
+}
+
+// Aplica os eventos de um registro, um a um, como a tarefa de eventos fez
+static void persist_reaplicar(ocupacao_t *oc, const persist_pagina_t *pag)
+{
+    ocupacao_saida_t saida;
+    for (uint8_t i = 0; i < pag->n && i < PERSIST_EVENTOS_PAGINA; ++i)
+    {
+        evento_t evento = pag->eventos[i];
+        ocupacao_processar(oc, &evento, 1, &saida);
+    }
+}
+
+// Restaura a contagem a partir do checkpoint mais recente e dos registros
+// gravados depois dele no mesmo setor. oc deve estar iniciado com a
+// configuração atual; um checkpoint de outra configuração é ignorado.
+// Deve ser chamada uma vez, antes de persist_anotar. Retorna true se havia estado salvo.
+bool persist_recuperar(ocupacao_t *oc)
+{
+    const persist_pagina_t *recente = NULL;
+
+    memcpy(&sombra, oc, sizeof(sombra));
+    for (uint8_t s = 0; s < PERSIST_SETORES; ++s)
+    {
+        const persist_pagina_t *pag = persist_ler(s, 0);
+        if (persist_valida(pag, PERSIST_CHECKPOINT) && (recente == NULL || pag->sequencia > recente->sequencia))
+        {
+            recente = pag;
+            setor = s;
+        }
+    }
+
+    // Região vazia ou de outra configuração: o primeiro registro abre o setor 0
+    if (recente == NULL || recente->n != oc->n_zonas)
+    {
+        setor = PERSIST_SETORES - 1;
+        pagina = PERSIST_PAGINAS_SETOR;
+        sequencia = recente != NULL ? recente->sequencia : 0;
+        return false;
+    }
+
+    memcpy(sombra.usuarios, recente->usuarios, sizeof(sombra.usuarios));
+    sequencia = recente->sequencia;
+    pagina = 1;
+
+    // Cauda do log: registros corrompidos (gravação interrompida) são pulados
+    for (uint8_t p = 1; p < PERSIST_PAGINAS_SETOR; ++p)
+    {
+        const persist_pagina_t *pag = persist_ler(setor, p);
+        if (persist_apagada(pag))
+            break;
+        pagina = p + 1;
+        if (persist_valida(pag, PERSIST_LOG) && pag->sequencia > sequencia)
+        {
+            persist_reaplicar(&sombra, pag);
+            sequencia = pag->sequencia;
+            stats.restaurados += pag->n;
+        }
+    }
+
+    memcpy(oc->usuarios, sombra.usuarios, sizeof(oc->usuarios));
+    return true;
+}
+
+// A contagem veio de uma cópia mais recente que a flash (registradores do
+// watchdog): ela passa a ser a sombra e o próximo registro abre um setor
+// novo com um checkpoint dela. Chamada depois de persist_recuperar.
+void persist_retomar(const ocupacao_t *oc)
+{
+    memcpy(sombra.usuarios, oc->usuarios, sizeof(sombra.usuarios));
+    pagina = PERSIST_PAGINAS_SETOR;
+}
+
+// Lado da tarefa de eventos: enfileira o lote já aplicado para gravação.
+// Retorna false se algum evento foi descartado.
+bool persist_anotar(const evento_t *eventos, uint8_t n)
+{
+    bool ok = true;
+    for (uint8_t i = 0; i < n; ++i)
+        ok = eventos_push(&fila, &eventos[i]) && ok;
+    stats.perdidos = fila.perdidos;
+    return ok;
+}
+
+// Grava o registro de log atual e o aplica à sombra
+static bool persist_fechar_log(void)
+{
+    if (pagina >= PERSIST_PAGINAS_SETOR && !persist_rodar())
+        return false;
+    log_atual.tipo = PERSIST_LOG;
+    if (!persist_programar(&log_atual))
+        return false;
+    persist_reaplicar(&sombra, &log_atual);
+    memset(&log_atual, 0, sizeof(log_atual));
+    return true;
+}
+
+// Lado da tarefa de gravação: junta os eventos em registros de uma página e
+// grava cada registro cheio. Com forcar, grava também o registro parcial.
+void persist_gravar(bool forcar)
+{
+    evento_t evento;
+
+    while (true)
+    {
+        // Flash indisponível: os eventos esperam na fila até o próximo ciclo
+        if (log_atual.n == PERSIST_EVENTOS_PAGINA && !persist_fechar_log())
+            return;
+        if (!eventos_pop(&fila, &evento))
+            break;
+        log_atual.eventos[log_atual.n++] = evento;
+    }
+
+    if (forcar && log_atual.n > 0)
+        persist_fechar_log();
+}
+
+// Lado da tarefa de gravação: há eventos ainda não gravados na flash
+bool persist_pendente(void)
+{
+    return log_atual.n > 0 || eventos_pendentes(&fila) > 0;
+}
+
+const persist_stats_t *persist_stats(void)
+{
+    return &stats;
+}
@@ -0,0 +1,53 @@
+#ifndef PERSISTENCIA_H
+#define PERSISTENCIA_H
+
+#include "hardware/flash.h"
+#include "ocupacao.h"
+
+// Região reservada no fim da flash, usada em rodízio setor a setor.
+// O firmware precisa caber antes de PERSIST_OFFSET.
+#define PERSIST_SETORES 32
+#define PERSIST_TAMANHO (PERSIST_SETORES * FLASH_SECTOR_SIZE)
+#define PERSIST_OFFSET (PICO_FLASH_SIZE_BYTES - PERSIST_TAMANHO)
+#define PERSIST_PAGINAS_SETOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+
+#define PERSIST_EVENTOS_PAGINA 30 // eventos por registro de log
+#define PERSIST_ATRASO_MS 2000    // página parcial é gravada após esse tempo sem eventos
+
+// Registro gravado em uma página da flash. A primeira página de cada setor é
+// um checkpoint (contagem de todas as zonas); as demais guardam eventos.
+typedef struct
+{
+    uint32_t magia;
+    uint32_t sequencia; // cresce a cada página gravada
+    uint8_t tipo;
+    uint8_t n;          // eventos (log) ou zonas (checkpoint)
+    uint16_t reservado;
+    union
+    {
+        evento_t eventos[PERSIST_EVENTOS_PAGINA];
+        uint16_t usuarios[OCUPACAO_MAX_ZONAS];
+    };
+    uint32_t crc;
+} persist_pagina_t;
+
+_Static_assert(sizeof(persist_pagina_t) == FLASH_PAGE_SIZE, "registro deve ocupar uma página");
+
+// Estatísticas da persistência
+typedef struct
+{
+    uint32_t paginas;     // páginas gravadas desde o boot
+    uint32_t setores;     // setores apagados desde o boot
+    uint32_t perdidos;    // eventos descartados com a fila cheia
+    uint32_t falhas;      // operações de flash não executadas
+    uint16_t restaurados; // eventos reaplicados na recuperação
+} persist_stats_t;
+
+bool persist_recuperar(ocupacao_t *oc);
+void persist_retomar(const ocupacao_t *oc);
+bool persist_anotar(const evento_t *eventos, uint8_t n);
+void persist_gravar(bool forcar);
+bool persist_pendente(void);
+const persist_stats_t *persist_stats(void);
+
+#endif
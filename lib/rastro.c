@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rastro.h"
+
+static const char tipos[] = {[EVENTO_ENTRADA] = 'e', [EVENTO_SAIDA] = 's', [EVENTO_RESET] = 'r'};
+
+// Lê uma linha do rastro. Retorna false para linhas vazias, comentários e
+// linhas inválidas, que são ignoradas.
+bool rastro_ler(const char *linha, evento_t *evento)
+{
+    char *p;
+    unsigned long instante = strtoul(linha, &p, 10);
+    if (p == linha)
+        return false;
+    while (*p == ' ' || *p == '\t')
+        ++p;
+    const char *tipo = memchr(tipos, *p, sizeof(tipos));
+    if (*p == '\0' || tipo == NULL)
+        return false;
+
+    char *fim;
+    unsigned long porta = strtoul(p + 1, &fim, 10);
+    if (fim == p + 1 || porta >= OCUPACAO_MAX_PORTAS)
+        return false;
+
+    evento->timestamp_us = (uint32_t)instante;
+    evento->tipo = (uint8_t)(tipo - tipos);
+    evento->porta = (uint8_t)porta;
+    return true;
+}
+
+// Escreve o evento como uma linha do rastro (com '\n'); retorna o tamanho como snprintf
+int rastro_formatar(char *linha, size_t n, const evento_t *evento)
+{
+    char tipo = evento->tipo < sizeof(tipos) ? tipos[evento->tipo] : '?';
+    return snprintf(linha, n, "%lu %c %u\n", (unsigned long)evento->timestamp_us, tipo, evento->porta);
+}
+
+// Contagem de referência: cada evento aplicado na ordem do rastro, sem fila
+// nem lotes, como se nenhum fosse perdido
+void rastro_referencia(ocupacao_t *referencia, const evento_t *evento)
+{
+    evento_t copia = *evento; // ocupacao_processar ordena o lote no lugar
+    ocupacao_saida_t saida;
+    ocupacao_processar(referencia, &copia, 1, &saida);
+}
+
+// Imprime vazão, perdas e a contagem final de cada zona contra a referência.
+// Retorna true se todas as zonas coincidem.
+bool rastro_relatorio(const rastro_resultado_t *r, const ocupacao_t *referencia, const uint16_t *usuarios)
+{
+    uint32_t consumidos = r->eventos - r->perdidos;
+    uint64_t taxa = r->duracao_us > 0 ? (uint64_t)consumidos * 1000000u / r->duracao_us : 0;
+    printf("rastro: %lu eventos, %lu perdidos, %lu.%03lu s, %llu eventos/s\n", (unsigned long)r->eventos,
+           (unsigned long)r->perdidos, (unsigned long)(r->duracao_us / 1000000u),
+           (unsigned long)(r->duracao_us / 1000u % 1000u), (unsigned long long)taxa);
+
+    bool iguais = true;
+    for (uint8_t z = 0; z < referencia->n_zonas; ++z)
+    {
+        bool igual = usuarios[z] == referencia->usuarios[z];
+        printf("  %-12s %5u usuarios, referencia %5u%s\n", referencia->zonas[z].nome, usuarios[z],
+               referencia->usuarios[z], igual ? "" : "  DIVERGENTE");
+        iguais = iguais && igual;
+    }
+    printf("rastro: %s\n", iguais ? "contagem confere" : "contagem divergente");
+    return iguais;
+}
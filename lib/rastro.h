@@ -0,0 +1,26 @@
+#ifndef RASTRO_H
+#define RASTRO_H
+
+#include <stddef.h>
+#include "ocupacao.h"
+
+// Rastro de eventos: uma linha por evento, "<instante_us> <tipo> <porta>",
+// com tipo e (entrada), s (saída) ou r (reset); '#' inicia comentário.
+// Gravado pelo telemetria_dec -r a partir dos quadros TEL_EVENTO e reproduzido
+// pelo host/rastro ou pelo comando r do console.
+#define RASTRO_LINHA_MAX 48
+
+// Resultado de uma reprodução
+typedef struct
+{
+    uint32_t eventos;    // eventos do rastro entregues à fila
+    uint32_t perdidos;   // descartados com a fila cheia
+    uint64_t duracao_us; // da primeira entrega ao último evento consumido
+} rastro_resultado_t;
+
+bool rastro_ler(const char *linha, evento_t *evento);
+int rastro_formatar(char *linha, size_t n, const evento_t *evento);
+void rastro_referencia(ocupacao_t *referencia, const evento_t *evento);
+bool rastro_relatorio(const rastro_resultado_t *r, const ocupacao_t *referencia, const uint16_t *usuarios);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef SAIDAS_H
+#define SAIDAS_H
+
+#include "ocupacao.h"
+#include "fila_spsc.h"
+
+// Capacidade da fila de atualizações de saída (potência de 2)
+#define SAIDAS_CAPACIDADE 8
+
+// Fila que leva as atualizações consolidadas da lógica (núcleo 0) para a
+// tarefa de LED, buzzer e display (núcleo 1 no modo SMP). O produtor publica
+// por saidas_publicar, então perdidos conta as atualizações juntadas por
+// falta de espaço, não descartadas.
+FILA_SPSC(saidas, ocupacao_saida_t, SAIDAS_CAPACIDADE)
+
+// Atualização que não coube na fila, guardada pelo produtor
+typedef struct
+{
+    ocupacao_saida_t saida;
+    bool pendente;
+} saidas_retida_t;
+
+// Junta a atualização anterior à seguinte: vale o estado da mais nova, os
+// eventos se somam, um reset é mantido e um alarme de lotado só é mantido
+// se não houve reset depois dele. A soma satura em 255: eventos == 0 marca a
+// contagem restaurada no boot e não pode surgir de uma volta do contador.
+static inline void saidas_juntar(ocupacao_saida_t *nova, const ocupacao_saida_t *anterior)
+{
+    uint16_t eventos = (uint16_t)nova->eventos + anterior->eventos;
+    nova->alarme_lotado = (nova->alarme_lotado || anterior->alarme_lotado) && !nova->reset;
+    nova->reset = nova->reset || anterior->reset;
+    nova->eventos = eventos > UINT8_MAX ? UINT8_MAX : eventos;
+}
+
+// Publica uma atualização (lado do produtor; saida NULL só tenta de novo a
+// retida). Com a fila cheia ela fica em retida e as seguintes são juntadas a
+// ela, para que alarme e reset cheguem às saídas. Retorna true se algo
+// entrou na fila.
+static inline bool saidas_publicar(saidas_fila_t *fila, saidas_retida_t *retida, const ocupacao_saida_t *saida)
+{
+    if (saida != NULL)
+    {
+        if (retida->pendente)
+        {
+            ocupacao_saida_t nova = *saida;
+            saidas_juntar(&nova, &retida->saida);
+            retida->saida = nova;
+            fila->perdidos++;
+        }
+        else
+        {
+            retida->saida = *saida;
+            retida->pendente = true;
+        }
+    }
+    if (!retida->pendente || saidas_pendentes(fila) >= SAIDAS_CAPACIDADE)
+        return false;
+    saidas_push(fila, &retida->saida);
+    retida->pendente = false;
+    return true;
+}
+
+#endif
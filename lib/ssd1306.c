@@ -1,5 +1,26 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+// Comandos de endereçamento enviados antes de cada janela
+#define SSD1306_WINDOW_CMDS 6
+
+static ssd1306_t *dma_owner; // display dono do canal DMA (há apenas um barramento)
+
+#if PAINEL_STATIC
+// Sem heap: buffers de um único display de até WIDTH x HEIGHT
+#define SSD1306_BUFSIZE ((HEIGHT / 8) * WIDTH + 1)
+static uint8_t ssd1306_ram[SSD1306_BUFSIZE];
+static uint8_t ssd1306_front[SSD1306_BUFSIZE];
+// O envio bloqueante e a DMA nunca estão ativos ao mesmo tempo (ambos
+// esperam o barramento), então dividem a mesma área
+static union {
+  uint8_t tx[SSD1306_BUFSIZE];
+  uint16_t dma[2 * SSD1306_WINDOW_CMDS + SSD1306_BUFSIZE];
+} ssd1306_envio;
+#endif
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -8,110 +29,445 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
+#if PAINEL_STATIC
+  if (ssd->bufsize > SSD1306_BUFSIZE)
+    panic("ssd1306: display maior que %dx%d", WIDTH, HEIGHT);
+  ssd->ram_buffer = ssd1306_ram;
+  ssd->front_buffer = ssd1306_front;
+  ssd->tx_buffer = ssd1306_envio.tx;
+  memset(ssd1306_ram, 0, sizeof(ssd1306_ram));
+  memset(ssd1306_front, 0, sizeof(ssd1306_front));
+#else
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->front_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->tx_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+#endif
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->dirty = false;
+  ssd->bytes_saved = 0;
+  ssd->frames_skipped = 0;
+  ssd->dma_chan = -1;
+  ssd->dma_buffer = NULL;
+  ssd->dma_busy = false;
+  ssd->last_xfer_us = 0;
+  ssd->timeouts = 0;
+  ssd->tx_aborts = 0;
+  ssd->front_stale = true;
+  ssd->baudrate = 0;
+  ssd->init_us = 0;
+  ssd->recoveries = 0;
+}
+
+// Expande a janela suja para incluir a coluna x da página page
+static inline void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x, uint8_t page) {
+  if (!ssd->dirty) {
+    ssd->dirty_x0 = ssd->dirty_x1 = x;
+    ssd->dirty_p0 = ssd->dirty_p1 = page;
+    ssd->dirty = true;
+    return;
+  }
+  if (x < ssd->dirty_x0) ssd->dirty_x0 = x;
+  if (x > ssd->dirty_x1) ssd->dirty_x1 = x;
+  if (page < ssd->dirty_p0) ssd->dirty_p0 = page;
+  if (page > ssd->dirty_p1) ssd->dirty_p1 = page;
+}
+
+// Escreve uma transação completa. Retorna false se o display não confirmou
+// (NAK) ou se o barramento travou (timeout de ~50 us por byte).
+static bool ssd1306_write(ssd1306_t *ssd, const uint8_t *src, size_t len) {
+  int sent = i2c_write_timeout_us(ssd->i2c_port, ssd->address, src, len, false, 1000 + len * 50);
+  if (sent == PICO_ERROR_TIMEOUT)
+    ssd->timeouts++;
+  return sent == (int)len;
 }
 
-void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+// Toda a configuração segue numa única lista de comandos (uma transação)
+bool ssd1306_config(ssd1306_t *ssd) {
+  const uint8_t cmds[] = {
+    SET_DISP | 0x00,
+    SET_MEM_ADDR, 0x01,
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, ssd->height - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, 0x12,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, 0x14,
+    SET_DISP | 0x01
+  };
+  return ssd1306_command_list(ssd, cmds, sizeof(cmds));
 }
 
+// Envia uma sequência de comandos (com argumentos) numa única transação:
+// o byte de controle 0x00 (Co = 0, D/C = 0) vale para todos os bytes seguintes.
+// Retorna false se o display não confirmou a transação.
+bool ssd1306_command_list(ssd1306_t *ssd, const uint8_t *cmds, size_t n) {
+  uint8_t buf[1 + SSD1306_CMDLIST_MAX];
+  if (n > SSD1306_CMDLIST_MAX)
+    panic("ssd1306: lista de %u comandos (maximo %d)", (unsigned)n, SSD1306_CMDLIST_MAX);
+  buf[0] = 0x00;
+  memcpy(&buf[1], cmds, n);
+  return ssd1306_write(ssd, buf, n + 1);
+}
+
+// Um comando por transação (0x80, comando); prefira ssd1306_command_list
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->port_buffer,
-    2,
-    false
-  );
-}
-
-void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  ssd1306_write(ssd, ssd->port_buffer, 2);
 }
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
-  uint8_t pixel = (y & 0b111);
-  if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
-  else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+// Interrompe a transferência assíncrona em andamento. A interrupção do canal
+// é desligada durante o abort (errata RP2040-E13).
+static void ssd1306_dma_abort(ssd1306_t *ssd) {
+  dma_channel_set_irq0_enabled(ssd->dma_chan, false);
+  dma_channel_abort(ssd->dma_chan);
+  dma_channel_acknowledge_irq0(ssd->dma_chan);
+  dma_channel_set_irq0_enabled(ssd->dma_chan, true);
+  ssd->dma_busy = false;
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+// Espera o envio em andamento terminar, por no máximo SSD1306_BUSY_TIMEOUT_US.
+// Ao expirar, a DMA é interrompida para que o canal possa ser reutilizado.
+static bool ssd1306_wait_idle(ssd1306_t *ssd) {
+  uint32_t start = time_us_32();
+  while (ssd1306_busy(ssd)) {
+    if (time_us_32() - start > SSD1306_BUSY_TIMEOUT_US) {
+      if (ssd->dma_busy)
+        ssd1306_dma_abort(ssd);
+      ssd->timeouts++;
+      ssd->front_stale = true;
+      return false;
+    }
+    tight_loop_contents();
+  }
+  return true;
+}
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
+// Contraste do painel (0x00 a 0xFF); o consumo do OLED cresce com ele
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t contrast) {
+  const uint8_t cmds[] = {SET_CONTRAST, contrast};
+  ssd1306_wait_idle(ssd);
+  ssd1306_command_list(ssd, cmds, sizeof(cmds));
+}
+
+// Liga o painel ou o põe em modo sleep (SET_DISP). A RAM do display é
+// preservada e continua aceitando quadros com o painel desligado.
+void ssd1306_power(ssd1306_t *ssd, bool on) {
+  ssd1306_wait_idle(ssd);
+  ssd1306_command(ssd, SET_DISP | (on ? 0x01 : 0x00));
+}
+
+// Envia o quadro inteiro. Retorna false se o display não confirmou.
+bool ssd1306_send_data(ssd1306_t *ssd) {
+  const uint8_t cmds[SSD1306_WINDOW_CMDS] = {
+    SET_COL_ADDR, 0, ssd->width - 1,
+    SET_PAGE_ADDR, 0, ssd->pages - 1
+  };
+  ssd1306_wait_idle(ssd);
+  bool ok = ssd1306_command_list(ssd, cmds, sizeof(cmds));
+  ok = ssd1306_write(ssd, ssd->ram_buffer, ssd->bufsize) && ok;
+  memcpy(ssd->front_buffer, ssd->ram_buffer, ssd->bufsize);
+  ssd->front_stale = !ok;
+  ssd->dirty = false;
+  return ok;
+}
+
+// Reduz a janela suja aos bytes que diferem do quadro da frente. Um fill
+// seguido do mesmo desenho marca a janela sem mudar o quadro; nesse caso
+// retorna false e nada precisa ser enviado.
+static bool ssd1306_diff_window(ssd1306_t *ssd) {
+  uint8_t x0 = 0, x1 = 0, p0 = ssd->pages - 1, p1 = 0;
+  bool changed = false;
+  for (uint8_t x = ssd->dirty_x0; x <= ssd->dirty_x1; ++x) {
+    size_t col = (x * ssd->pages) + 1;
+    for (uint8_t p = ssd->dirty_p0; p <= ssd->dirty_p1; ++p) {
+      if (ssd->ram_buffer[col + p] == ssd->front_buffer[col + p])
+        continue;
+      if (!changed)
+        x0 = x;
+      changed = true;
+      x1 = x;
+      if (p < p0) p0 = p;
+      if (p > p1) p1 = p;
+    }
+  }
+  ssd->dirty_x0 = x0;
+  ssd->dirty_x1 = x1;
+  ssd->dirty_p0 = p0;
+  ssd->dirty_p1 = p1;
+  return changed;
+}
+
+// Copia a janela suja (0x40 seguido dos dados) para o quadro da frente e para
+// bytes, no envio bloqueante, ou words, como palavras IC_DATA_CMD da DMA; o
+// outro ponteiro é NULL. Com endereçamento vertical (SET_MEM_ADDR 0x01) o
+// display percorre as páginas de cada coluna antes de avançar, então a
+// janela é copiada coluna a coluna. Retorna o total escrito.
+static size_t ssd1306_pack_window(ssd1306_t *ssd, uint8_t *bytes, uint16_t *words) {
+  uint8_t npages = ssd->dirty_p1 - ssd->dirty_p0 + 1;
+  size_t len = 0;
+  if (words)
+    words[len++] = 0x40;
+  else
+    bytes[len++] = 0x40;
+  for (uint8_t x = ssd->dirty_x0; x <= ssd->dirty_x1; ++x) {
+    size_t offset = (x * ssd->pages) + ssd->dirty_p0 + 1;
+    const uint8_t *col = &ssd->ram_buffer[offset];
+    memcpy(&ssd->front_buffer[offset], col, npages);
+    for (uint8_t p = 0; p < npages; ++p, ++len) {
+      if (words)
+        words[len] = col[p];
+      else
+        bytes[len] = col[p];
     }
+  }
+  return len;
+}
+
+// Espera o quadro anterior e reduz a janela ao que mudou. Retorna o tamanho
+// a enviar (incluindo o 0x40), ou 0 quando o back buffer é igual ao quadro
+// da frente. Se o último envio falhou o quadro da frente não reflete o
+// painel, então a tela vai inteira.
+static size_t ssd1306_next_frame(ssd1306_t *ssd) {
+  ssd1306_wait_idle(ssd);
+  bool changed;
+  if (ssd->front_stale) {
+    ssd->front_stale = false;
+    ssd->dirty_x0 = 0;
+    ssd->dirty_x1 = ssd->width - 1;
+    ssd->dirty_p0 = 0;
+    ssd->dirty_p1 = ssd->pages - 1;
+    changed = true;
+  } else {
+    changed = ssd->dirty && ssd1306_diff_window(ssd);
+  }
+  ssd->dirty = false;
+  if (!changed) {
+    ssd->frames_skipped++;
+    ssd->bytes_saved += ssd->bufsize - 1;
+    return 0;
+  }
+  size_t ncols = ssd->dirty_x1 - ssd->dirty_x0 + 1;
+  size_t len = 1 + ncols * (ssd->dirty_p1 - ssd->dirty_p0 + 1);
+  ssd->bytes_saved += ssd->bufsize - len;
+  return len;
 }
 
+// Envia apenas a janela alterada desde o último envio
+void ssd1306_flush(ssd1306_t *ssd) {
+  size_t len = ssd1306_next_frame(ssd);
+  if (len == 0)
+    return;
+
+  const uint8_t cmds[SSD1306_WINDOW_CMDS] = {
+    SET_COL_ADDR, ssd->dirty_x0, ssd->dirty_x1,
+    SET_PAGE_ADDR, ssd->dirty_p0, ssd->dirty_p1
+  };
+  ssd1306_pack_window(ssd, ssd->tx_buffer, NULL);
+  uint32_t start = time_us_32();
+  if (!ssd1306_command_list(ssd, cmds, sizeof(cmds)) || !ssd1306_write(ssd, ssd->tx_buffer, len))
+    ssd->front_stale = true;
+  ssd->last_xfer_us = time_us_32() - start;
+}
 
+// Com TX_ABRT ativo (NAK do display) o controlador esvazia a FIFO de TX e
+// descarta tudo o que é escrito nela até o abort ser limpo. Retorna true se
+// o envio em andamento foi perdido.
+static bool ssd1306_check_abort(ssd1306_t *ssd) {
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (!(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS))
+    return false;
+  (void)hw->clr_tx_abrt;
+  ssd->tx_aborts++;
+  ssd->front_stale = true;
+  return true;
+}
 
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
+// Fim da DMA: os últimos bytes ainda podem estar na FIFO do I2C,
+// ssd1306_busy() cobre esse intervalo.
+static void ssd1306_dma_irq_handler(void) {
+  ssd1306_t *ssd = dma_owner;
+  if (ssd == NULL || ssd->dma_chan < 0 || !dma_channel_get_irq0_status(ssd->dma_chan))
+    return;
+  dma_channel_acknowledge_irq0(ssd->dma_chan);
+  ssd1306_check_abort(ssd);
+  ssd->last_xfer_us = time_us_32() - ssd->xfer_start_us;
+  ssd->dma_busy = false;
+  if (ssd->dma_done)
+    ssd->dma_done(ssd->dma_done_ctx);
+}
+
+// Reserva um canal DMA para o envio assíncrono. Retorna false se não houver
+// canal livre; nesse caso ssd1306_swap usa o envio bloqueante. Com a DMA o
+// tx_buffer passa a ocupar a mesma área do dma_buffer: os dois envios nunca
+// estão ativos ao mesmo tempo.
+bool ssd1306_dma_init(ssd1306_t *ssd, void (*done)(void *ctx), void *ctx) {
+  int chan = dma_claim_unused_channel(false);
+  if (chan < 0)
+    return false;
+
+#if PAINEL_STATIC
+  ssd->dma_buffer = ssd1306_envio.dma;
+#else
+  ssd->dma_buffer = calloc(2 * SSD1306_WINDOW_CMDS + ssd->bufsize, sizeof(uint16_t));
+  if (ssd->dma_buffer == NULL) {
+    dma_channel_unclaim(chan);
+    return false;
+  }
+  free(ssd->tx_buffer);
+  ssd->tx_buffer = (uint8_t *)ssd->dma_buffer;
+#endif
+
+  dma_channel_config c = dma_channel_get_default_config(chan);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(ssd->i2c_port, true));
+  dma_channel_configure(chan, &c, &i2c_get_hw(ssd->i2c_port)->data_cmd, ssd->dma_buffer, 0, false);
+
+  ssd->dma_chan = chan;
+  ssd->dma_done = done;
+  ssd->dma_done_ctx = ctx;
+  dma_owner = ssd;
+  dma_channel_set_irq0_enabled(chan, true);
+  irq_add_shared_handler(DMA_IRQ_0, ssd1306_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_0, true);
+  return true;
+}
+
+// true enquanto a DMA ou o próprio I2C ainda estão transmitindo. Um abort
+// do controlador encerra o envio: a DMA restante é interrompida.
+bool ssd1306_busy(ssd1306_t *ssd) {
+  if (ssd->dma_chan < 0)
+    return false;
+  if (ssd1306_check_abort(ssd)) {
+    if (ssd->dma_busy)
+      ssd1306_dma_abort(ssd);
+    return false;
   }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
+  if (ssd->dma_busy)
+    return true;
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  return (hw->status & I2C_IC_STATUS_ACTIVITY_BITS) || !(hw->status & I2C_IC_STATUS_TFE_BITS);
+}
+
+// Monta a janela suja como uma sequência de palavras IC_DATA_CMD: os comandos
+// de endereçamento formam uma lista (0x00, cmds) terminada em STOP e os dados
+// seguem numa segunda transação. O controlador gera um novo START sozinho
+// após cada STOP, então a DMA alimenta a FIFO de TX sem intervenção da CPU.
+//
+// Troca de buffers: o back buffer vira o quadro da frente e a janela alterada
+// segue por DMA a partir de uma cópia, então o próximo desenho no back buffer
+// pode começar durante o envio. Retorna false quando caiu no envio bloqueante
+// (sem DMA) ou quando o quadro era igual ao da frente e não foi enviado.
+bool ssd1306_swap(ssd1306_t *ssd) {
+  if (ssd->dma_chan < 0) {
+    ssd1306_flush(ssd);
+    return false;
   }
+  size_t len = ssd1306_next_frame(ssd);
+  if (len == 0)
+    return false;
+
+  const uint8_t cmds[SSD1306_WINDOW_CMDS] = {
+    SET_COL_ADDR, ssd->dirty_x0, ssd->dirty_x1,
+    SET_PAGE_ADDR, ssd->dirty_p0, ssd->dirty_p1
+  };
+  uint16_t *w = ssd->dma_buffer;
+  *w++ = 0x00;
+  for (uint8_t i = 0; i < SSD1306_WINDOW_CMDS; ++i)
+    *w++ = cmds[i];
+  w[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  w += ssd1306_pack_window(ssd, NULL, w);
+  w[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+  (void)hw->clr_tx_abrt;
+
+  ssd->dma_busy = true;
+  ssd->xfer_start_us = time_us_32();
+  dma_channel_transfer_from_buffer_now(ssd->dma_chan, ssd->dma_buffer, w - ssd->dma_buffer);
+  return true;
+}
+
+// Substitui os bits de mask no byte (x, page) pelos de bits e marca a janela
+// suja se ele mudou. Retorna true quando o byte foi alterado.
+static inline bool ssd1306_write_bits(ssd1306_t *ssd, uint8_t x, uint8_t page, uint8_t mask, uint8_t bits) {
+  uint8_t *byte = &ssd->ram_buffer[(x * ssd->pages) + page + 1];
+  uint8_t v = (*byte & ~mask) | (bits & mask);
+  if (v == *byte)
+    return false;
+  *byte = v;
+  ssd1306_mark_dirty(ssd, x, page);
+  return true;
+}
+
+// Liga (value) ou apaga os bits de mask no byte (x, page)
+static inline bool ssd1306_write_mask(ssd1306_t *ssd, uint8_t x, uint8_t page, uint8_t mask, bool value) {
+  return ssd1306_write_bits(ssd, x, page, mask, value ? 0xFF : 0x00);
+}
+
+// Máscara dos bits y0..y1 (0..7) de um byte de página
+static inline uint8_t ssd1306_span_mask(uint8_t y0, uint8_t y1) {
+  return (uint8_t)((0xFFu << y0) & (0xFFu >> (7 - y1)));
+}
+
+void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  ssd1306_write_mask(ssd, x, y >> 3, 1 << (y & 0b111), value);
+}
+
+// Preenche o buffer inteiro com memset. Antes procura as colunas que realmente
+// mudam para que a janela suja continue mínima (fill + redesenho é o caso comum).
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  uint8_t byte = value ? 0xFF : 0x00;
+  uint8_t *data = ssd->ram_buffer + 1;
+  size_t n = ssd->bufsize - 1;
+  size_t first = 0, last = n;
+
+  while (first < n && data[first] == byte)
+    ++first;
+  if (first == n)
+    return;
+  while (data[last - 1] == byte)
+    --last;
+
+  memset(data + first, byte, last - first);
+  ssd1306_mark_dirty(ssd, first / ssd->pages, 0);
+  ssd1306_mark_dirty(ssd, (last - 1) / ssd->pages, ssd->pages - 1);
+}
+
+void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+  if (width == 0 || height == 0 || left >= ssd->width || top >= ssd->height)
+    return;
+  uint8_t right = (left + width - 1 < ssd->width) ? left + width - 1 : ssd->width - 1;
+  uint8_t bottom = (top + height - 1 < ssd->height) ? top + height - 1 : ssd->height - 1;
 
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    // Cada coluna do retângulo é um trecho vertical
+    for (uint16_t x = left; x <= right; ++x)
+      ssd1306_vline(ssd, x, top, bottom, value);
+    return;
   }
+
+  // As bordas cortadas pela tela não são desenhadas
+  ssd1306_hline(ssd, left, right, top, value);
+  if (top + height - 1 == bottom)
+    ssd1306_hline(ssd, left, right, bottom, value);
+  ssd1306_vline(ssd, left, top, bottom, value);
+  if (left + width - 1 == right)
+    ssd1306_vline(ssd, right, top, bottom, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
@@ -142,15 +498,58 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
     }
 }
 
-
+// Linha horizontal: um único bit por coluna, avançando de uma coluna (pages bytes) por vez
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  if (x0 > x1) {
+    uint8_t t = x0;
+    x0 = x1;
+    x1 = t;
+  }
+  if (y >= ssd->height || x0 >= ssd->width)
+    return;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+
+  uint8_t page = y >> 3;
+  uint8_t mask = 1 << (y & 0b111);
+  uint8_t *byte = &ssd->ram_buffer[(x0 * ssd->pages) + page + 1];
+  int first = -1, last = -1;
+  for (uint16_t x = x0; x <= x1; ++x, byte += ssd->pages) {
+    uint8_t v = value ? (*byte | mask) : (*byte & ~mask);
+    if (v != *byte) {
+      *byte = v;
+      if (first < 0)
+        first = x;
+      last = x;
+    }
+  }
+  if (first >= 0) {
+    ssd1306_mark_dirty(ssd, first, page);
+    ssd1306_mark_dirty(ssd, last, page);
+  }
 }
 
+// Linha vertical: bytes mascarados nas páginas das pontas e bytes cheios no meio
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  if (y0 > y1) {
+    uint8_t t = y0;
+    y0 = y1;
+    y1 = t;
+  }
+  if (x >= ssd->width || y0 >= ssd->height)
+    return;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+
+  uint8_t p0 = y0 >> 3, p1 = y1 >> 3;
+  if (p0 == p1) {
+    ssd1306_write_mask(ssd, x, p0, ssd1306_span_mask(y0 & 0b111, y1 & 0b111), value);
+    return;
+  }
+  ssd1306_write_mask(ssd, x, p0, ssd1306_span_mask(y0 & 0b111, 7), value);
+  for (uint8_t p = p0 + 1; p < p1; ++p)
+    ssd1306_write_mask(ssd, x, p, 0xFF, value);
+  ssd1306_write_mask(ssd, x, p1, ssd1306_span_mask(0, y1 & 0b111), value);
 }
 
 // Função para desenhar um caractere
@@ -169,13 +568,31 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
     index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
   }
 
-  // Desenha o caractere na tela
+  // Cada byte da fonte é uma coluna do glifo, no mesmo formato das páginas do
+  // display: alinhado a 8 pixels o glifo ocupa um byte por coluna em uma única
+  // página; fora do alinhamento ele é deslocado e dividido entre duas páginas.
+  const uint8_t *glyph = &font[index];
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 0b111;
+  bool lower = page + 1 < ssd->pages; // a segunda página existe na tela
+
+  if (y >= ssd->height)
+    return;
+
   for (uint8_t i = 0; i < 8; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
+    uint16_t col = x + i;
+    if (col >= ssd->width)
+      break;
+    if (shift == 0)
+    {
+      ssd1306_write_bits(ssd, col, page, 0xFF, glyph[i]);
+    }
+    else
     {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
+      ssd1306_write_bits(ssd, col, page, 0xFF << shift, glyph[i] << shift);
+      if (lower)
+        ssd1306_write_bits(ssd, col, page + 1, 0xFF >> (8 - shift), glyph[i] >> (8 - shift));
     }
   }
 }
@@ -199,32 +616,178 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
   }
 }
 
+// Copia um bitmap já no formato do buffer: uma coluna por vez, com os bytes
+// das páginas contíguos, então cada coluna é um único memcpy. Com overlay os
+// bits do bitmap são somados (OR) ao que já está desenhado.
+void ssd1306_blit(ssd1306_t *ssd, const ssd1306_bitmap_t *bmp, bool overlay) {
+  if (bmp->width == 0 || bmp->pages == 0 || bmp->x >= ssd->width || bmp->page >= ssd->pages)
+    return;
+  uint8_t width = (bmp->x + bmp->width <= ssd->width) ? bmp->width : ssd->width - bmp->x;
+  uint8_t pages = (bmp->page + bmp->pages <= ssd->pages) ? bmp->pages : ssd->pages - bmp->page;
+
+  const uint8_t *src = bmp->data;
+  uint8_t *dst = &ssd->ram_buffer[(bmp->x * ssd->pages) + bmp->page + 1];
+  if (!overlay && pages == ssd->pages && bmp->pages == ssd->pages) {
+    // Colunas inteiras: o bitmap é contíguo no buffer
+    memcpy(dst, src, (size_t)width * pages);
+  } else {
+    for (uint8_t x = 0; x < width; ++x, src += bmp->pages, dst += ssd->pages) {
+      if (overlay) {
+        for (uint8_t p = 0; p < pages; ++p)
+          dst[p] |= src[p];
+      } else {
+        memcpy(dst, src, pages);
+      }
+    }
+  }
+
+  // A janela cobre o bitmap inteiro; ssd1306_swap descarta o que não mudou
+  ssd1306_mark_dirty(ssd, bmp->x, bmp->page);
+  ssd1306_mark_dirty(ssd, bmp->x + width - 1, bmp->page + pages - 1);
+}
+
+// Expande o RLE coluna a coluna, para imagens que não cobrem colunas inteiras
+static void ssd1306_image_columns(ssd1306_t *ssd, const ssd1306_image_t *img, const uint8_t *src,
+                                  const uint8_t *end, uint8_t *col, uint8_t width, uint8_t pages, bool overlay) {
+  uint8_t cx = 0, p = 0; // posição na imagem
+  while (src < end && cx < width) {
+    uint8_t ctrl = *src++;
+    bool run = ctrl & 0x80;
+    uint8_t n = run ? ctrl - 0x80 + 3 : ctrl + 1;
+    // Trecho truncado: a repetição precisa do byte, o literal de n bytes
+    if (run ? src == end : n > end - src)
+      break;
+    for (; n > 0 && cx < width; --n) {
+      uint8_t v = run ? *src : *src++;
+      if (p < pages)
+        col[p] = overlay ? (col[p] | v) : v;
+      if (++p == img->pages) {
+        p = 0;
+        col += ssd->pages;
+        ++cx;
+      }
+    }
+    if (run)
+      ++src;
+  }
+}
+
+// Desenha a imagem com o canto superior esquerdo na coluna x e na página
+// page. Sem compressão é um ssd1306_blit; com RLE os bytes são expandidos
+// direto no buffer, na mesma ordem (coluna a coluna).
+void ssd1306_image(ssd1306_t *ssd, const ssd1306_image_t *img, uint8_t x, uint8_t page, bool overlay) {
+  if (!(img->flags & SSD1306_IMAGE_RLE)) {
+    const ssd1306_bitmap_t bmp = {x, page, img->width, img->pages, img->data};
+    ssd1306_blit(ssd, &bmp, overlay);
+    return;
+  }
+  if (img->width == 0 || img->pages == 0 || x >= ssd->width || page >= ssd->pages)
+    return;
+  uint8_t width = (x + img->width <= ssd->width) ? img->width : ssd->width - x;
+  uint8_t pages = (page + img->pages <= ssd->pages) ? img->pages : ssd->pages - page;
+
+  const uint8_t *src = img->data, *end = img->data + img->size;
+  uint8_t *col = &ssd->ram_buffer[(x * ssd->pages) + page + 1];
+
+  if (!overlay && pages == ssd->pages && img->pages == ssd->pages) {
+    // Colunas inteiras: o destino é contíguo e cada trecho é um memset ou memcpy
+    size_t left = (size_t)width * pages;
+    while (src < end && left > 0) {
+      uint8_t ctrl = *src++;
+      size_t len = (ctrl & 0x80) ? ctrl - 0x80 + 3 : ctrl + 1;
+      size_t n = len < left ? len : left;
+      if (ctrl & 0x80) {
+        if (src == end)
+          break;
+        memset(col, *src++, n);
+      } else {
+        if (len > (size_t)(end - src))
+          break;
+        memcpy(col, src, n);
+        src += len;
+      }
+      col += n;
+      left -= n;
+    }
+  } else {
+    ssd1306_image_columns(ssd, img, src, end, col, width, pages, overlay);
+  }
+
+  ssd1306_mark_dirty(ssd, x, page);
+  ssd1306_mark_dirty(ssd, x + width - 1, page + pages - 1);
+}
+
+// Libera o barramento preso por um escravo no meio de um byte (SDA em 0):
+// com os pinos como GPIO em dreno aberto, até 9 pulsos de SCL e um STOP.
+// Retorna true se SDA ficou em 1.
+static bool ssd1306_bus_clear(void) {
+  i2c_deinit(I2C_PORT);
+  gpio_init(I2C_SDA);
+  gpio_init(I2C_SCL);
+  gpio_pull_up(I2C_SDA);
+  gpio_pull_up(I2C_SCL);
+  gpio_put(I2C_SDA, 0); // saída em 0 quando a direção é OUT; IN solta a linha
+  gpio_put(I2C_SCL, 0);
+
+  for (uint8_t i = 0; i < 9 && !gpio_get(I2C_SDA); ++i) {
+    gpio_set_dir(I2C_SCL, GPIO_OUT);
+    busy_wait_us_32(5);
+    gpio_set_dir(I2C_SCL, GPIO_IN);
+    busy_wait_us_32(5);
+  }
+
+  // STOP: SDA sobe com SCL em 1
+  gpio_set_dir(I2C_SDA, GPIO_OUT);
+  busy_wait_us_32(5);
+  gpio_set_dir(I2C_SDA, GPIO_IN);
+  busy_wait_us_32(5);
+  return gpio_get(I2C_SDA);
+}
+
+// Recuperação após um timeout do barramento: interrompe a DMA, libera o
+// barramento e refaz initDisplay. Os buffers e o canal DMA são mantidos e o
+// back buffer é reenviado inteiro.
+void ssd1306_recover(ssd1306_t *ssd) {
+  if (ssd->dma_chan >= 0)
+    ssd1306_dma_abort(ssd);
+  ssd1306_bus_clear();
+  initDisplay(ssd);
+  ssd->recoveries++;
+}
+
 void initDisplay(ssd1306_t *ssd)
 {
-  // I2C Initialisation. Using it at 400Khz.
-  i2c_init(I2C_PORT, 400 * 1000);
+  uint32_t start = time_us_32();
+
+  // I2C a 400 kHz, ou 1 MHz com SSD1306_I2C_FMP
+  uint baudrate = i2c_init(I2C_PORT, SSD1306_I2C_FMP ? SSD1306_I2C_FMP_HZ : SSD1306_I2C_HZ);
   gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);                   // Set the GPIO pin function to I2C
   gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);                   // Set the GPIO pin function to I2C
   gpio_pull_up(I2C_SDA);                                       // Pull up the data line
   gpio_pull_up(I2C_SCL);                                       // Pull up the clock line
-  ssd1306_init(ssd, WIDTH, HEIGHT, false, endereco, I2C_PORT); // Inicializa o display
-  ssd1306_config(ssd);                                         // Configura o display
-  ssd1306_send_data(ssd);                                      // Envia os dados para o display
+
+  // Inicializa o display; na recuperação (ssd1306_recover) mantém os buffers
+  if (ssd->ram_buffer == NULL)
+    ssd1306_init(ssd, WIDTH, HEIGHT, false, endereco, I2C_PORT);
+
+  // Configura o display e envia o primeiro quadro. O SSD1306 não pode ser lido
+  // pelo I2C, então a verificação a 1 MHz é o ACK de todas as transações; sem
+  // ele a configuração é refeita a 400 kHz, que é a velocidade da especificação.
+  bool ok = ssd1306_config(ssd) && ssd1306_send_data(ssd);
+  if (!ok && baudrate > SSD1306_I2C_HZ) {
+    baudrate = i2c_set_baudrate(I2C_PORT, SSD1306_I2C_HZ);
+    ssd1306_config(ssd);
+    ssd1306_send_data(ssd);
+  }
+
+  ssd->baudrate = baudrate;
+  ssd->init_us = time_us_32() - start;
 }
 
-void desenhar(ssd1306_t *ssd, const uint32_t desenho[8192])
+// Desenha a imagem na tela inteira (os pixels apagados não alteram o buffer) e envia.
+// As imagens exportadas pelo Piskel são convertidas na compilação por imagem_conv.
+void desenhar(ssd1306_t *ssd, const ssd1306_image_t *desenho)
 {
-  // Desenho feito ao exportar o arquivo no Piskelapp automatizado
-  for (int j = 0; j < 64; j++)
-  {
-    for (int i = 0; i < 128; i++)
-    {
-      int a = j * 128 + i;
-      if (desenho[a] >= 0xff000000)
-      {
-        ssd1306_pixel(ssd, i, j, true);
-      }
-    }
-  }
+  ssd1306_image(ssd, desenho, 0, 0, true);
   ssd1306_send_data(ssd); // Atualiza o display
-}
\ No newline at end of file
+}
@@ -1,7 +1,14 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define WIDTH 128
 #define HEIGHT 64
 
@@ -10,6 +17,22 @@
 #define I2C_SCL 15
 #define endereco 0x3C
 
+// Frequência do I2C do display. Com SSD1306_I2C_FMP (opção PAINEL_I2C_1MHZ)
+// initDisplay tenta o Fast-mode Plus e volta para 400 kHz se o display não
+// confirmar a configuração nessa velocidade.
+#ifndef SSD1306_I2C_FMP
+#define SSD1306_I2C_FMP 0
+#endif
+#define SSD1306_I2C_HZ (400 * 1000)
+#define SSD1306_I2C_FMP_HZ (1000 * 1000)
+
+// Maior lista de comandos enviada numa única transação
+#define SSD1306_CMDLIST_MAX 32
+
+// Espera máxima pelo fim de um envio antes de um comando (um quadro inteiro
+// leva ~25 ms a 400 kHz). Ao expirar a espera é contada em timeouts.
+#define SSD1306_BUSY_TIMEOUT_US 100000
+
 typedef enum {
   SET_CONTRAST = 0x81,
   SET_ENTIRE_ON = 0xA4,
@@ -34,15 +57,61 @@ typedef struct {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
-  uint8_t *ram_buffer;
+  uint8_t *ram_buffer;                             // back buffer: onde o desenho acontece
+  uint8_t *front_buffer;                           // quadro da frente: último entregue ao barramento
+  volatile bool front_stale;                       // um envio falhou: o quadro da frente não vale e a tela vai inteira
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint8_t *tx_buffer;                              // envio bloqueante da janela suja (mesma área do dma_buffer com DMA)
+  uint8_t dirty_x0, dirty_x1, dirty_p0, dirty_p1;  // janela suja (colunas/páginas)
+  bool dirty;                                      // há bytes alterados desde o último envio
+  uint32_t bytes_saved;                            // bytes que deixaram de ir para o barramento
+  uint32_t frames_skipped;                         // quadros iguais ao da frente, não enviados
+  int dma_chan;                                    // canal DMA do envio assíncrono (-1 = sem DMA)
+  uint16_t *dma_buffer;                            // palavras IC_DATA_CMD (byte + bits de STOP)
+  volatile bool dma_busy;                          // transferência assíncrona em andamento
+  void (*dma_done)(void *ctx);                     // chamado na IRQ ao fim da transferência
+  void *dma_done_ctx;
+  uint32_t xfer_start_us;                          // início da última transferência
+  volatile uint32_t last_xfer_us;                  // duração da última transferência (us)
+  uint32_t timeouts;                               // transações e esperas pelo barramento que expiraram
+  volatile uint32_t tx_aborts;                     // envios assíncronos abortados pelo I2C (NAK)
+  uint32_t baudrate;                               // frequência real do I2C após initDisplay
+  uint32_t init_us;                                // duração de initDisplay (configuração + primeiro quadro)
+  uint32_t recoveries;                             // recuperações do barramento (ssd1306_recover)
 } ssd1306_t;
 
+// Bitmap no formato do buffer: coluna a coluna, um byte por página (bit 0 em cima)
+typedef struct {
+  uint8_t x, page;      // canto superior esquerdo (coluna, página)
+  uint8_t width, pages; // colunas e páginas
+  const uint8_t *data;  // width * pages bytes
+} ssd1306_bitmap_t;
+
+// Imagem 1bpp gravada na flash, gerada por host/imagem_conv no mesmo formato
+// do bitmap. Com SSD1306_IMAGE_RLE os bytes estão comprimidos: controle
+// 0..127 = 1..128 bytes literais em seguida; 128..255 = o próximo byte
+// repetido 3..130 vezes.
+#define SSD1306_IMAGE_RLE 0x01
+
+typedef struct {
+  uint8_t width, pages;
+  uint8_t flags;       // SSD1306_IMAGE_*
+  uint16_t size;       // bytes em data
+  const uint8_t *data;
+} ssd1306_image_t;
+
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
-void ssd1306_config(ssd1306_t *ssd);
+bool ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
-void ssd1306_send_data(ssd1306_t *ssd);
+bool ssd1306_command_list(ssd1306_t *ssd, const uint8_t *cmds, size_t n);
+bool ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_flush(ssd1306_t *ssd);
+bool ssd1306_dma_init(ssd1306_t *ssd, void (*done)(void *ctx), void *ctx);
+bool ssd1306_swap(ssd1306_t *ssd);
+bool ssd1306_busy(ssd1306_t *ssd);
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t contrast);
+void ssd1306_power(ssd1306_t *ssd, bool on);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -52,6 +121,16 @@ void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+void ssd1306_blit(ssd1306_t *ssd, const ssd1306_bitmap_t *bmp, bool overlay);
+void ssd1306_image(ssd1306_t *ssd, const ssd1306_image_t *img, uint8_t x, uint8_t page, bool overlay);
+
+void ssd1306_recover(ssd1306_t *ssd);
 
 void initDisplay(ssd1306_t *ssd);
-void desenhar(ssd1306_t *ssd, const uint32_t desenho[8192]);
+void desenhar(ssd1306_t *ssd, const ssd1306_image_t *desenho);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include "supervisor.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+
+#define SUP_MAGIA 0x53555000u // "SUP" + número de zonas no byte baixo
+
+// Estado de cada etapa. desde_us e ocupada só são escritos pela dona da
+// etapa; atrasada e pedido, pelo supervisor (o pedido é apagado pela dona).
+typedef struct
+{
+    volatile uint32_t desde_us;
+    volatile bool ocupada;
+    volatile bool pedido;
+    bool atrasada;
+} sup_etapa_estado_t;
+
+static sup_etapa_estado_t etapas[SUP_ETAPAS];
+static sup_stats_t stats[SUP_ETAPAS];
+static bool watchdog_ativo;
+static bool restaurado; // a contagem do boot veio dos registradores do watchdog
+
+static const char *const nomes[SUP_ETAPAS] = {"entrada", "logica", "display"};
+
+// Define os prazos e liga o watchdog (watchdog_ms = 0 só supervisiona).
+// O watchdog para enquanto o depurador segura a CPU.
+void sup_init(const uint32_t prazo_us[SUP_ETAPAS], uint32_t watchdog_ms)
+{
+    for (uint8_t e = 0; e < SUP_ETAPAS; ++e)
+        stats[e].prazo_us = prazo_us[e];
+    if (watchdog_ms > 0)
+    {
+        watchdog_enable(watchdog_ms, true);
+        watchdog_ativo = true;
+    }
+}
+
+// A etapa começou um trabalho gerado em origem_us. Se já estava ocupada,
+// o trabalho mais antigo continua valendo para o prazo.
+void sup_inicio(sup_etapa_t etapa, uint32_t origem_us)
+{
+    sup_etapa_estado_t *e = &etapas[etapa];
+    if (e->ocupada)
+        return;
+    e->desde_us = origem_us;
+    __dmb(); // a origem fica visível antes da marcação
+    e->ocupada = true;
+}
+
+// A etapa concluiu o trabalho e voltou a esperar
+void sup_fim(sup_etapa_t etapa)
+{
+    sup_etapa_estado_t *e = &etapas[etapa];
+    if (!e->ocupada)
+        return;
+    int32_t duracao = (int32_t)(time_us_32() - e->desde_us);
+    if (duracao > (int32_t)stats[etapa].pior_us)
+        stats[etapa].pior_us = duracao;
+    e->ocupada = false;
+}
+
+// Chamada periodicamente pelo supervisor. Retorna a máscara das etapas
+// atrasadas e só alimenta o watchdog quando não há nenhuma. Cada atraso é
+// contado uma vez e deixa um pedido de recuperação para a dona da etapa.
+uint8_t sup_verificar(void)
+{
+    uint8_t atrasadas = 0;
+    for (uint8_t i = 0; i < SUP_ETAPAS; ++i)
+    {
+        sup_etapa_estado_t *e = &etapas[i];
+        bool atrasada = false;
+        if (e->ocupada)
+        {
+            __dmb();
+            // Com sinal: uma origem marcada depois da leitura do relógio não é atraso
+            int32_t idade = (int32_t)(time_us_32() - e->desde_us);
+            atrasada = e->ocupada && idade > (int32_t)stats[i].prazo_us;
+        }
+        if (atrasada)
+        {
+            atrasadas |= 1u << i;
+            if (!e->atrasada)
+            {
+                stats[i].atrasos++;
+                e->pedido = true;
+            }
+        }
+        e->atrasada = atrasada;
+    }
+
+    if (atrasadas == 0 && watchdog_ativo)
+        watchdog_update();
+    return atrasadas;
+}
+
+// Lado da dona da etapa: true (uma vez) se o supervisor pediu recuperação
+bool sup_pedido(sup_etapa_t etapa)
+{
+    if (!etapas[etapa].pedido)
+        return false;
+    etapas[etapa].pedido = false;
+    return true;
+}
+
+// Guarda a contagem nos registradores do watchdog. O cabeçalho é apagado
+// antes das zonas, então um reset no meio da escrita invalida a cópia.
+// Com mais de SUP_ZONAS_SALVAS zonas nada é guardado e vale a flash.
+void sup_salvar(const uint16_t *usuarios, uint8_t n_zonas)
+{
+    if (n_zonas > SUP_ZONAS_SALVAS)
+        return;
+    watchdog_hw->scratch[0] = 0;
+    for (uint8_t i = 0; i < SUP_ZONAS_SALVAS / 2; ++i)
+    {
+        uint16_t par = 2 * i < n_zonas ? usuarios[2 * i] : 0;
+        uint16_t impar = 2 * i + 1 < n_zonas ? usuarios[2 * i + 1] : 0;
+        watchdog_hw->scratch[1 + i] = par | (uint32_t)impar << 16;
+    }
+    watchdog_hw->scratch[0] = SUP_MAGIA | n_zonas;
+}
+
+// Recupera a contagem guardada se o boot veio de um reset do watchdog e a
+// cópia é da mesma configuração. Retorna false após um boot normal.
+bool sup_restaurar(uint16_t *usuarios, uint8_t n_zonas)
+{
+    if (!watchdog_caused_reboot() || watchdog_hw->scratch[0] != (SUP_MAGIA | n_zonas))
+        return false;
+    for (uint8_t z = 0; z < n_zonas; ++z)
+        usuarios[z] = (uint16_t)(watchdog_hw->scratch[1 + z / 2] >> (16 * (z % 2)));
+    restaurado = true;
+    return true;
+}
+
+void sup_relatorio(void)
+{
+    printf("supervisor: watchdog %s%s\n", watchdog_ativo ? "ativo" : "desligado",
+           restaurado ? ", contagem restaurada do watchdog no boot" : "");
+    printf("etapa        prazo(us)  atrasos    pior(us)  estado\n");
+    for (uint8_t e = 0; e < SUP_ETAPAS; ++e)
+        printf("%-10s %11lu %8lu %11lu  %s\n", nomes[e], (unsigned long)stats[e].prazo_us,
+               (unsigned long)stats[e].atrasos, (unsigned long)stats[e].pior_us,
+               etapas[e].atrasada ? "atrasada" : (etapas[e].ocupada ? "ocupada" : "em dia"));
+}
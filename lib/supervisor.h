@@ -0,0 +1,38 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include "pico/stdlib.h"
+
+// Etapas supervisionadas. Cada uma marca o início de um trabalho (com a origem
+// do evento que o gerou) e o fim; ocupada além do prazo, a etapa está atrasada.
+// Parada sem trabalho (bloqueada numa fila) conta como em dia.
+typedef enum
+{
+    SUP_ENTRADA, // borda na ISR -> evento retirado da fila pela tarefa de eventos
+    SUP_LOGICA,  // lote retirado da fila -> atualização publicada
+    SUP_DISPLAY, // estado de tela recebido -> quadro concluído no barramento
+    SUP_ETAPAS
+} sup_etapa_t;
+
+// Contagem guardada nos registradores de rascunho do watchdog, que sobrevivem
+// ao reset dele: scratch[0] identifica o conteúdo e scratch[1..3] guardam até
+// 6 zonas de 16 bits (o SDK usa scratch[4..7] em watchdog_reboot)
+#define SUP_ZONAS_SALVAS 6
+
+typedef struct
+{
+    uint32_t prazo_us;
+    uint32_t atrasos; // vezes em que o prazo foi perdido
+    uint32_t pior_us; // maior duração de um trabalho concluído
+} sup_stats_t;
+
+void sup_init(const uint32_t prazo_us[SUP_ETAPAS], uint32_t watchdog_ms);
+void sup_inicio(sup_etapa_t etapa, uint32_t origem_us);
+void sup_fim(sup_etapa_t etapa);
+uint8_t sup_verificar(void);
+bool sup_pedido(sup_etapa_t etapa);
+void sup_salvar(const uint16_t *usuarios, uint8_t n_zonas);
+bool sup_restaurar(uint16_t *usuarios, uint8_t n_zonas);
+void sup_relatorio(void);
+
+#endif
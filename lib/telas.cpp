@@ -0,0 +1,166 @@
+// Telas do painel pré-renderizadas na compilação.
+//
+// Os textos fixos de cada tela são desenhados por funções constexpr, com a
+// mesma fonte e nas mesmas posições de ssd1306_draw_string, direto no formato
+// de páginas do buffer. Em tempo de execução a tela é um memcpy por coluna;
+// a contagem usa algarismos também pré-renderizados e o nome da zona é
+// renderizado uma vez e reaproveitado enquanto a zona não muda.
+
+#include <stddef.h>
+#include <string.h>
+#include "telas.h"
+#include "font.h"
+
+namespace
+{
+
+// Linhas de texto (y do topo do caractere); todas começam em x = TELAS_X
+constexpr uint8_t Y_ESPERA[2] = {25, 34};
+constexpr uint8_t Y_TITULO[2] = {10, 19};
+constexpr uint8_t Y_ZONA = 35;
+constexpr uint8_t Y_CONTAGEM = 44;
+constexpr char ROTULO_CONTAGEM[] = "Usuarios: ";
+constexpr uint8_t X_ALGARISMOS = (sizeof(ROTULO_CONTAGEM) - 1) * 8; // relativo a TELAS_X
+constexpr uint8_t ALGARISMOS_MAX = 5;                                // uint16_t
+
+// Textos das duas linhas de cada tela, na ordem de tela_t (a de espera não mostra contagem)
+constexpr const char *TEXTOS[TELAS][2] = {
+    {"Aguardando ", "  evento..."}, // TELA_ESPERA
+    {"Entrada ", "Detectada!"},     // TELA_ENTRADA
+    {"Saida ", "Detectada!"},       // TELA_SAIDA
+    {"Espaco ", "Lotado!"},         // TELA_LOTADO
+    {"Espaco ", "Vazio!"},          // TELA_VAZIO
+    {"Reset ", "Detectado!"},       // TELA_RESET
+};
+
+constexpr bool na_area(uint8_t y)
+{
+    return y / 8 >= TELAS_PAGINA && (y + 7) / 8 < TELAS_PAGINA + TELAS_PAGINAS;
+}
+static_assert(na_area(Y_ESPERA[0]) && na_area(Y_ESPERA[1]) && na_area(Y_TITULO[0]) && na_area(Y_TITULO[1]) &&
+                  na_area(Y_ZONA) && na_area(Y_CONTAGEM),
+              "texto fora da area das telas");
+static_assert(X_ALGARISMOS + ALGARISMOS_MAX * 8 <= TELAS_LARGURA, "contagem fora da area das telas");
+
+// Soma o texto a um bitmap de C colunas e P páginas que começa na página
+// pagina0. Como em ssd1306_draw_char, fora do alinhamento de 8 pixels cada
+// coluna do glifo é dividida entre duas páginas. O que passa de C é cortado.
+template <size_t C, size_t P>
+constexpr uint8_t escrever(uint8_t (&dados)[C][P], uint8_t pagina0, const char *texto, uint8_t y)
+{
+    uint8_t pagina = y / 8 - pagina0;
+    uint8_t desloc = y % 8;
+    size_t x = 0;
+    for (; *texto && x + 8 <= C; ++texto, x += 8)
+    {
+        char c = *texto;
+        size_t indice = (c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0;
+        for (size_t i = 0; i < 8; ++i)
+        {
+            dados[x + i][pagina] |= (uint8_t)(font[indice + i] << desloc);
+            if (desloc != 0 && pagina + 1u < P)
+                dados[x + i][pagina + 1] |= (uint8_t)(font[indice + i] >> (8 - desloc));
+        }
+    }
+    return (uint8_t)x;
+}
+
+// Parte fixa de uma tela: área inteira, para que a troca apague a anterior
+struct quadro_t
+{
+    uint8_t dados[TELAS_LARGURA][TELAS_PAGINAS];
+};
+
+constexpr quadro_t renderizar(tela_t tela)
+{
+    quadro_t q{};
+    if (tela == TELA_ESPERA)
+    {
+        escrever(q.dados, TELAS_PAGINA, TEXTOS[tela][0], Y_ESPERA[0]);
+        escrever(q.dados, TELAS_PAGINA, TEXTOS[tela][1], Y_ESPERA[1]);
+    }
+    else
+    {
+        escrever(q.dados, TELAS_PAGINA, TEXTOS[tela][0], Y_TITULO[0]);
+        escrever(q.dados, TELAS_PAGINA, TEXTOS[tela][1], Y_TITULO[1]);
+        escrever(q.dados, TELAS_PAGINA, ROTULO_CONTAGEM, Y_CONTAGEM);
+    }
+    return q;
+}
+
+constexpr quadro_t QUADROS[TELAS] = {
+    renderizar(TELA_ESPERA), renderizar(TELA_ENTRADA), renderizar(TELA_SAIDA),
+    renderizar(TELA_LOTADO), renderizar(TELA_VAZIO),   renderizar(TELA_RESET),
+};
+
+// Algarismos 0-9 já deslocados para a linha da contagem
+constexpr uint8_t PAGINA_CONTAGEM = Y_CONTAGEM / 8;
+
+struct algarismos_t
+{
+    uint8_t glifo[10][8][2];
+};
+
+constexpr algarismos_t renderizar_algarismos()
+{
+    algarismos_t a{};
+    for (uint8_t d = 0; d < 10; ++d)
+    {
+        const char texto[2] = {(char)('0' + d), '\0'};
+        escrever(a.glifo[d], PAGINA_CONTAGEM, texto, Y_CONTAGEM);
+    }
+    return a;
+}
+
+constexpr algarismos_t ALGARISMOS = renderizar_algarismos();
+
+// Nome da última zona mostrada, renderizado na linha da zona
+constexpr uint8_t PAGINA_ZONA = Y_ZONA / 8;
+
+struct
+{
+    const char *nome;
+    uint8_t largura;
+    uint8_t dados[TELAS_LARGURA][2];
+} zona_cache;
+
+// Algarismos decimais de v em algarismos[inicio..ALGARISMOS_MAX - 1], sem printf
+uint8_t decimal(uint16_t v, uint8_t algarismos[ALGARISMOS_MAX])
+{
+    uint8_t inicio = ALGARISMOS_MAX;
+    do
+    {
+        algarismos[--inicio] = v % 10;
+        v /= 10;
+    } while (v != 0);
+    return inicio;
+}
+
+} // namespace
+
+// Usada apenas pela tarefa do display (o cache da zona não é protegido)
+void telas_desenhar(ssd1306_t *ssd, tela_t tela, const char *zona, uint16_t usuarios)
+{
+    const ssd1306_bitmap_t quadro = {TELAS_X, TELAS_PAGINA, TELAS_LARGURA, TELAS_PAGINAS, &QUADROS[tela].dados[0][0]};
+    ssd1306_blit(ssd, &quadro, false);
+    if (tela == TELA_ESPERA)
+        return;
+
+    // As linhas da zona e da contagem dividem uma página, mas não os mesmos bits
+    if (zona != zona_cache.nome)
+    {
+        memset(zona_cache.dados, 0, sizeof(zona_cache.dados));
+        zona_cache.largura = escrever(zona_cache.dados, PAGINA_ZONA, zona, Y_ZONA);
+        zona_cache.nome = zona;
+    }
+    const ssd1306_bitmap_t faixa = {TELAS_X, PAGINA_ZONA, zona_cache.largura, 2, &zona_cache.dados[0][0]};
+    ssd1306_blit(ssd, &faixa, true);
+
+    uint8_t algarismos[ALGARISMOS_MAX];
+    uint8_t x = TELAS_X + X_ALGARISMOS;
+    for (uint8_t i = decimal(usuarios, algarismos); i < ALGARISMOS_MAX; ++i, x += 8)
+    {
+        const ssd1306_bitmap_t glifo = {x, PAGINA_CONTAGEM, 8, 2, &ALGARISMOS.glifo[algarismos[i]][0][0]};
+        ssd1306_blit(ssd, &glifo, true);
+    }
+}
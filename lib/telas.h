@@ -0,0 +1,38 @@
+#ifndef TELAS_H
+#define TELAS_H
+
+#include "ssd1306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Telas exibidas pelo renderizador
+typedef enum
+{
+    TELA_ESPERA,
+    TELA_ENTRADA,
+    TELA_SAIDA,
+    TELA_LOTADO,
+    TELA_VAZIO,
+    TELA_RESET,
+    TELAS
+} tela_t;
+
+// Área do display ocupada pelas telas (colunas TELAS_X..TELAS_X + TELAS_LARGURA - 1,
+// páginas TELAS_PAGINA..TELAS_PAGINA + TELAS_PAGINAS - 1). Fora dela o buffer
+// não é desenhado e continua apagado.
+#define TELAS_X 5
+#define TELAS_LARGURA 120 // 15 caracteres de 8 colunas
+#define TELAS_PAGINA 1
+#define TELAS_PAGINAS 6
+
+// Desenha a tela no back buffer: a parte fixa vem pronta da compilação e só
+// o nome da zona e a contagem são compostos em tempo de execução
+void telas_desenhar(ssd1306_t *ssd, tela_t tela, const char *zona, uint16_t usuarios);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
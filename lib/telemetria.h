@@ -0,0 +1,134 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+// Telemetria binária enviada pela USB no lugar das mensagens de depuração.
+// Quadro: TEL_SINC, tamanho do conteúdo, tipo, conteúdo (little-endian) e
+// o XOR de tamanho, tipo e conteúdo. Bytes fora de quadros são texto do
+// console; host/telemetria_dec.c separa e decodifica os dois.
+#define TEL_SINC 0xA5
+#define TEL_CONTEUDO_MAX 32
+
+typedef enum
+{
+    TEL_EVENTO = 1,  // evento retirado da fila pela tarefa de eventos
+    TEL_LOTE,        // resultado de um lote aplicado à contagem
+    TEL_QUADRO,      // quadro enviado ao display
+    TEL_PERDAS,      // contadores de descarte (periódico)
+    TEL_RESTAURADO,  // contagem recuperada da flash no boot
+} tel_tipo_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t timestamp_us; // borda na ISR
+    uint32_t latencia_us;  // ISR -> tarefa de eventos
+    uint8_t tipo;          // evento_tipo_t
+    uint8_t porta;
+} tel_evento_t;
+
+#define TEL_LOTE_LOTADO (1 << 0)
+#define TEL_LOTE_RESET (1 << 1)
+
+typedef struct __attribute__((packed))
+{
+    uint32_t timestamp_us;
+    uint16_t usuarios;
+    uint8_t zona;
+    uint8_t resultado; // ocupacao_resultado_t do último evento
+    uint8_t eventos;
+    uint8_t avisos;    // TEL_LOTE_*
+} tel_lote_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t timestamp_us;
+    uint32_t envio_us;       // 0 quando o quadro não foi enviado
+    uint32_t bytes_poupados;
+    uint32_t quadros_iguais; // quadros iguais ao anterior, não enviados
+    uint8_t tela;
+} tel_quadro_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t timestamp_us;
+    uint32_t eventos;    // fila de eventos dos botões
+    uint32_t saidas;     // atualizações de saída juntadas com a fila cheia
+    uint32_t telemetria; // quadros de telemetria
+    uint32_t flash;      // eventos não gravados na flash
+} tel_perdas_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t timestamp_us;
+    uint16_t usuarios;
+    uint8_t zona;
+} tel_restaurado_t;
+
+// Capacidade de cada canal em bytes (potência de 2)
+#define TEL_CAPACIDADE 1024
+
+// Canal sem trava de um produtor (uma tarefa) para a tarefa que envia pela USB.
+// head só é escrito pelo produtor e tail só pelo consumidor.
+typedef struct
+{
+    uint8_t dados[TEL_CAPACIDADE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t perdidos; // quadros descartados com o canal cheio
+} tel_canal_t;
+
+// Monta o quadro em buf e retorna o tamanho total
+static inline uint8_t tel_montar(uint8_t *buf, uint8_t tipo, const void *conteudo, uint8_t n)
+{
+    uint8_t x = n ^ tipo;
+    buf[0] = TEL_SINC;
+    buf[1] = n;
+    buf[2] = tipo;
+    memcpy(&buf[3], conteudo, n);
+    for (uint8_t i = 0; i < n; ++i)
+        x ^= buf[3 + i];
+    buf[3 + n] = x;
+    return n + 4;
+}
+
+// Escreve um quadro (lado do produtor). Retorna false e conta a perda se não houver espaço.
+static inline bool tel_enviar(tel_canal_t *canal, uint8_t tipo, const void *conteudo, uint8_t n)
+{
+    uint8_t quadro[TEL_CONTEUDO_MAX + 4];
+    uint8_t total = tel_montar(quadro, tipo, conteudo, n);
+    uint32_t head = canal->head;
+
+    if (TEL_CAPACIDADE - (head - canal->tail) < total)
+    {
+        canal->perdidos++;
+        return false;
+    }
+    for (uint8_t i = 0; i < total; ++i)
+        canal->dados[(head + i) & (TEL_CAPACIDADE - 1)] = quadro[i];
+    __dmb(); // o quadro inteiro precisa estar visível antes do novo head
+    canal->head = head + total;
+    return true;
+}
+
+// Copia até max bytes (lado do consumidor) e retorna quantos copiou. O head só
+// avança com quadros completos, mas o corte em max pode cair no meio de um
+// quadro: o restante sai na próxima chamada, então os bytes drenados devem
+// ser escritos em ordem, sem tratar cada chamada como quadros inteiros.
+static inline uint32_t tel_drenar(tel_canal_t *canal, uint8_t *saida, uint32_t max)
+{
+    uint32_t tail = canal->tail;
+    uint32_t n = canal->head - tail;
+    if (n > max)
+        n = max;
+    __dmb();
+    for (uint32_t i = 0; i < n; ++i)
+        saida[i] = canal->dados[(tail + i) & (TEL_CAPACIDADE - 1)];
+    __dmb(); // a leitura termina antes de liberar o espaço
+    canal->tail = tail + n;
+    return n;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef ZONAS_H
+#define ZONAS_H
+
+#include "ocupacao.h"
+
+// Zonas monitoradas (capacidade e vagas restantes para o aviso amarelo).
+// Cada zona vem depois da zona que a contém. Exemplo de um andar com duas salas:
+//   {"Andar", 40, 4, OCUPACAO_FORA}, {"Sala 1", 8, 1, 0}, {"Sala 2", 20, 2, 0}
+// com as portas {0, OCUPACAO_FORA}, {1, 0} e {2, 0}.
+// Usadas pelo firmware e pela reprodução de rastros no host (host/rastro.c).
+enum
+{
+    ZONA_SALA,
+};
+
+static const ocupacao_zona_cfg_t zonas[] = {
+    [ZONA_SALA] = {"Sala", 8, 1, OCUPACAO_FORA},
+};
+
+// Portas: zona acessada e de onde se vem
+enum
+{
+    PORTA_PRINCIPAL,
+};
+
+static const ocupacao_porta_cfg_t portas[] = {
+    [PORTA_PRINCIPAL] = {ZONA_SALA, OCUPACAO_FORA},
+};
+
+#endif